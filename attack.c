@@ -0,0 +1,52 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifdef PEXT
+#include <immintrin.h>
+#endif
+
+#include "attack.h"
+
+static myuint64_t
+attack_lookup(const struct attack_magic_t* M, myuint64_t occupied);
+
+myuint64_t attack_bit(int sq)
+{
+    return (myuint64_t)1 << sq;
+}
+
+myuint64_t attack_rook(int sq, myuint64_t occupied)
+{
+    return attack_lookup(attack_rooks + sq, occupied);
+}
+
+myuint64_t attack_bishop(int sq, myuint64_t occupied)
+{
+    return attack_lookup(attack_bishops + sq, occupied);
+}
+
+myuint64_t attack_queen(int sq, myuint64_t occupied)
+{
+    return attack_rook(sq, occupied) | attack_bishop(sq, occupied);
+}
+
+int attack_first(myuint64_t bb)
+{
+    return __builtin_ctzl(bb);
+}
+
+int attack_count(myuint64_t bb)
+{
+    return __builtin_popcountl(bb);
+}
+
+static myuint64_t
+attack_lookup(const struct attack_magic_t* M, myuint64_t occupied)
+{
+#ifdef PEXT
+    return attack_table[M->offset + _pext_u64(occupied, M->mask)];
+#else
+    return attack_table
+        [M->offset + ((occupied & M->mask) * M->magic >> M->shift)];
+#endif
+}
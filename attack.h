@@ -0,0 +1,77 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_ATTACK_H
+#define CMC_CHESS_ATTACK_H
+
+#include "int.h"
+
+/* Attack sets and board geometry as bitboards.
+ *
+ * Squares are numbered as in struct board_t (8 * row + col, a8 being 0) and
+ * bit sq of a bitboard stands for square sq. The attack set of a piece holds
+ * every square it reaches on an otherwise empty board, up to and including
+ * the first occupied square of each direction, whatever its colour.
+ *
+ * The occupied squares that matter to a slider on sq (its rays, edges
+ * excluded) are mapped to an index into a table of precomputed attack sets:
+ * by a multiplication by a magic number and a shift, or by the PEXT
+ * instruction in builds with -DPEXT (x86-64 with BMI2, see CMakeLists.txt).
+ *
+ * Every table is generated at build time by tools/attack_gen.c, which also
+ * searches the magic numbers.
+ */
+
+/* Entries of attack_table: the sum over the squares of 2 to the number of
+ * relevant squares of a rook on them (102400), then of a bishop (5248) */
+#define ATTACK_ENTRIES 107648
+
+typedef struct attack_magic_t
+{
+    myuint64_t mask;   /* Relevant squares */
+    myuint64_t magic;  /* 0 with PEXT */
+    myuint32_t offset; /* Of the attack sets of the square in attack_table */
+    myuint32_t shift;  /* 64 minus the number of relevant squares */
+}* attack_magic_p;
+
+extern const struct attack_magic_t attack_rooks[64];
+extern const struct attack_magic_t attack_bishops[64];
+extern const myuint64_t            attack_table[ATTACK_ENTRIES];
+
+/* Squares attacked from sq by a knight, a king, a white pawn (index 0,
+ * towards row 0) and a black pawn (index 1) */
+extern const myuint64_t attack_knights[64];
+extern const myuint64_t attack_kings[64];
+extern const myuint64_t attack_pawns[2][64];
+
+/* Squares strictly between a and b, or the whole line through them, if they
+ * share a row, a column or a diagonal; 0 otherwise (also when a == b). The
+ * path, check and pin tests of board_check_move read them */
+extern const myuint64_t attack_between[64][64];
+extern const myuint64_t attack_line[64][64];
+
+/* King moves from a to b */
+extern const myuint8_t attack_distance[64][64];
+
+/* RETURN
+ * The bitboard with only square sq set.
+ */
+extern myuint64_t attack_bit(int sq);
+
+extern myuint64_t attack_rook(int sq, myuint64_t occupied);
+extern myuint64_t attack_bishop(int sq, myuint64_t occupied);
+
+/* Union of attack_rook and attack_bishop */
+extern myuint64_t attack_queen(int sq, myuint64_t occupied);
+
+/* RETURN
+ * The lowest square of bb, that must not be empty.
+ */
+extern int attack_first(myuint64_t bb);
+
+/* RETURN
+ * The number of squares of bb.
+ */
+extern int attack_count(myuint64_t bb);
+
+#endif /* CMC_CHESS_ATTACK_H */
@@ -0,0 +1,162 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#include <stdio.h>
+
+#include "bench.h"
+#include "board.h"
+#include "exit_codes.h"
+#include "search.h"
+#include "util.h"
+
+/* A position and the depths it is worked at */
+typedef struct bench_pos_t
+{
+    const char* fen;
+    int         perft_depth;
+    int         search_depth;
+}* bench_pos_p;
+
+/* Opening, middle game and end game: castling does not matter, the board
+ * does not model it */
+static const struct bench_pos_t BENCH_POSITIONS[] = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w - - 0 1", 5, 6},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w - - 0 1",
+     4,
+     5},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 8}
+};
+
+/* A workload on B to depth.
+ *
+ * RETURN
+ * The nodes it visited.
+ */
+typedef unsigned long (*bench_work_t)(board_p B, turn_t turn, int depth);
+
+static unsigned long bench_perft(board_p B, turn_t turn, int depth);
+static unsigned long bench_search(board_p B, turn_t turn, int depth);
+
+/* Run work rounds times, setting *nodes to the nodes of a run.
+ *
+ * RETURN
+ * The time of the fastest run, in ms.
+ */
+static double bench_time(
+    bench_work_t   work,
+    board_p        B,
+    turn_t         turn,
+    int            depth,
+    unsigned int   rounds,
+    unsigned long* nodes
+);
+
+int bench_run(unsigned int rounds)
+{
+    struct board_t            B;
+    turn_t                    turn;
+    const char*               err;
+    const struct bench_pos_t* P;
+    unsigned long             nodes;
+    unsigned long             perft_nodes  = 0;
+    unsigned long             search_nodes = 0;
+    double                    ms;
+    double                    perft_ms  = 0;
+    double                    search_ms = 0;
+    size_t                    i;
+
+    printf("Board backend: %s, best of %u rounds\n", board_backend(), rounds);
+
+    for (i = 0; i < sizeof(BENCH_POSITIONS) / sizeof(*BENCH_POSITIONS); ++i)
+    {
+        P   = BENCH_POSITIONS + i;
+        err = board_from_fen(&B, &turn, P->fen, NULL);
+        if (err != NULL)
+        {
+            fprintf(stderr, "Error: `%s`: %s.\n", P->fen, err);
+            return CHESS_GAME_ERROR;
+        }
+
+        ms = bench_time(bench_perft, &B, turn, P->perft_depth, rounds, &nodes);
+        printf(
+            "%lu: perft %d: %10lu nodes in %8.1f ms\n",
+            (unsigned long)i + 1,
+            P->perft_depth,
+            nodes,
+            ms
+        );
+        perft_nodes += nodes;
+        perft_ms += ms;
+
+        ms = bench_time(
+            bench_search, &B, turn, P->search_depth, rounds, &nodes
+        );
+        printf(
+            "%lu: search %d: %9lu nodes in %8.1f ms\n",
+            (unsigned long)i + 1,
+            P->search_depth,
+            nodes,
+            ms
+        );
+        search_nodes += nodes;
+        search_ms += ms;
+    }
+
+    printf(
+        "perft: %lu nodes in %.1f ms (%.0f nodes/s)\n",
+        perft_nodes,
+        perft_ms,
+        perft_ms > 0 ? (double)perft_nodes * 1000.0 / perft_ms : 0.0
+    );
+    printf(
+        "search: %lu nodes in %.1f ms (%.0f nodes/s)\n",
+        search_nodes,
+        search_ms,
+        search_ms > 0 ? (double)search_nodes * 1000.0 / search_ms : 0.0
+    );
+
+    return CHESS_OK;
+}
+
+static unsigned long bench_perft(board_p B, turn_t turn, int depth)
+{
+    return board_perft(B, turn, (unsigned int)depth);
+}
+
+static unsigned long bench_search(board_p B, turn_t turn, int depth)
+{
+    struct search_t S;
+
+    search_init(&S);
+    S.max_depth = depth;
+    search_run(&S, B, turn);
+
+    return S.nodes;
+}
+
+static double bench_time(
+    bench_work_t   work,
+    board_p        B,
+    turn_t         turn,
+    int            depth,
+    unsigned int   rounds,
+    unsigned long* nodes
+)
+{
+    unsigned int r;
+    double       start;
+    double       ms;
+    double       best = 0;
+
+    for (r = 0; r == 0 || r < rounds; ++r)
+    {
+        start  = clock_ms();
+        *nodes = work(B, turn, depth);
+        ms     = clock_ms() - start;
+
+        if (r == 0 || ms < best)
+            best = ms;
+    }
+
+    return best;
+}
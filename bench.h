@@ -0,0 +1,20 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_BENCH_H
+#define CMC_CHESS_BENCH_H
+
+/* Time fixed workloads (perft and fixed depth searches of a few positions)
+ * on the board backend of the build (see BOARD_CELLS in board.h), so that
+ * builds with different backends can be compared on the same work: node
+ * counts do not depend on the backend, times do.
+ *
+ * Every workload is run rounds times (at least once) and its fastest run is
+ * reported.
+ *
+ * RETURN
+ * An exit code (see exit_codes.h).
+ */
+extern int bench_run(unsigned int rounds);
+
+#endif /* CMC_CHESS_BENCH_H */
@@ -1,14 +1,31 @@
 /* Copyright (c) 2025 Mattia Cabrini      */
 /* SPDX-License-Identifier: AGPL-3.0-only */
 
+#ifdef AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "attack.h"
 #include "board.h"
 #include "int.h"
 #include "util.h"
 
+#include <ctype.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 
+/* Rows pawns morph on, as bitboards (see attack.h) */
+static const myuint64_t BOARD_ROW_0 = 0xFFUL;
+static const myuint64_t BOARD_ROW_7 = MYUINT64_C(0xFF00000000000000);
+
+/* How board_scan compares the cells of a board to a piece */
+#define BOARD_SCAN_EQ 0
+#define BOARD_SCAN_GT 1 /* Greater than: cpEEMPTY for the white pieces */
+#define BOARD_SCAN_LT 2 /* Less than: cpEEMPTY for the black pieces */
+
 /* Data needed to restore a board from a simulated move */
 typedef struct simul_restore_t
 {
@@ -61,6 +78,17 @@ const char* ILLEGAL_MOVE_QUEEN_DESC =
 const char* ILLEGAL_MOVE_KING_DESC =
     "King can only move one position and cannot take over";
 
+const char* BOARD_FEN_ERR_PLACEMENT  = "bad FEN: piece placement";
+const char* BOARD_FEN_ERR_KING       = "bad FEN: more than one King per player";
+const char* BOARD_FEN_ERR_TURN       = "bad FEN: side to move";
+const char* BOARD_FEN_ERR_CASTLING   = "bad FEN: castling availability";
+const char* BOARD_FEN_ERR_EN_PASSANT = "bad FEN: en passant target square";
+const char* BOARD_FEN_ERR_CLOCK      = "bad FEN: clock";
+const char* BOARD_FEN_ERR_TRAILING   = "bad FEN: unexpected trailing chars";
+
+const char* BOARD_PACKED_ERR_PIECE = "packed board: not a piece";
+const char* BOARD_PACKED_ERR_KING  = "packed board: two Kings of a player";
+
 static const char* board_is_illegal_PAWN_move(board_p B, move_p M);
 static const char* board_is_illegal_ROOK_move(board_p B, move_p M);
 static const char* board_is_illegal_KNIGHT_move(board_p B, move_p M);
@@ -68,20 +96,16 @@ static const char* board_is_illegal_BISHOP_move(board_p B, move_p M);
 static const char* board_is_illegal_QUEEN_move(board_p B, move_p M);
 static const char* board_is_illegal_KING_move(board_p B, move_p M);
 
-/* Check and return any viable straight move by increments of incr.
- * incr should be R/C=-1/-1, for diagonal move going TL, R/C=1/-1, going BL, ...
- */
-static size_t board_list_ANY_STRAIGHT_moves(
-    board_p, coord_p src, coord_p incr, coord_p dst, size_t n
+/* List the squares of targets, but the ones of the pieces of the owner of
+ * src */
+static size_t board_list_targets(
+    board_p B, coord_p src, myuint64_t targets, coord_p dst, size_t n
 );
-static int board_can_move_nc(board_p B, coord_p src, coord_p king);
 
 /* These functions tell any possible move by source BUT they do not check
  * whether or not a move might result in a check
  */
 static size_t
-board_list_PAWN_moves(board_p, coord_p src, coord_p dst, size_t n);
-static size_t
 board_list_ROOK_moves(board_p, coord_p src, coord_p dst, size_t n);
 static size_t
 board_list_BISHOP_moves(board_p, coord_p src, coord_p dst, size_t n);
@@ -94,8 +118,26 @@ board_list_KING_moves(board_p, coord_p src, coord_p dst, size_t n);
 
 static const char* board_check_move_direction(board_p B, move_p M, turn_t turn);
 
+/* RETURN
+ * 1 if a piece stands between the source and the dest of M, 0 otherwise.
+ */
+static int board_path_blocked(board_p B, move_p M);
+
 static const char* board_colour(coord_p C);
 
+/* Parse the piece placement field of a FEN string into B, kings included.
+ *
+ * RETURN
+ * A pointer to the first char after the field, NULL on error (*err is set).
+ */
+static const char*
+board_fen_placement(board_p B, const char* fen, const char** err);
+
+/* Skip a FEN field made only of chars in accept (possibly none).
+ * Return NULL if the field contains anything else.
+ */
+static const char* board_fen_skip_field(const char* fen, const char* accept);
+
 /* Initialize R and simulate src->dst on B
  *
  * WARNING
@@ -108,46 +150,689 @@ board_simulation_do(board_p B, simul_restore_p R, coord_p src, coord_p dst);
 static void
 board_simulation_undo(board_p B, simul_restore_p R, coord_p src, coord_p dst);
 
+static int        board_list_slot(int colour, int i);
+static void       board_list_add(board_p B, int sq);
+static void       board_list_remove(board_p B, int sq);
+static int        board_pieces(board_p B, int colour, int* sq);
+static int        board_square(coord_p C);
+static int        board_cell(int sq);
+static int        board_step_off(int sq, int rows, int cols);
+static myuint64_t board_scan(board_p B, int cmp, piece_t p);
+
+/* Set *C to the square of king on B, if any.
+ *
+ * RETURN
+ * 0 if there is more than one, 1 otherwise.
+ */
+static int board_find_king(board_p B, piece_t king, coord_p C);
+static myuint64_t board_occupied(board_p B);
+
+/* The colour-specialised functions of board_side.inc, for white and for
+ * black: C89 has no templates, so the names and the constants that differ
+ * are macros (see board_side.inc) */
+#define SIDE(name) name##_WHITE
+#define SIDE_US BOARD_WHITE
+#define SIDE_THEM BOARD_BLACK
+#define SIDE_PAWN cpWPAWN
+#define SIDE_KING cpWKING
+#define SIDE_KING_AT wking
+#define SIDE_PUSH (-1)
+#define SIDE_START_ROW 6
+#define SIDE_LAST_ROW BOARD_ROW_0
+#define SIDE_MORPH_FIRST cpWROOK
+#define SIDE_MORPH_LAST cpWQUEEN
+#include "board_side.inc"
+#undef SIDE
+#undef SIDE_US
+#undef SIDE_THEM
+#undef SIDE_PAWN
+#undef SIDE_KING
+#undef SIDE_KING_AT
+#undef SIDE_PUSH
+#undef SIDE_START_ROW
+#undef SIDE_LAST_ROW
+#undef SIDE_MORPH_FIRST
+#undef SIDE_MORPH_LAST
+
+#define SIDE(name) name##_BLACK
+#define SIDE_US BOARD_BLACK
+#define SIDE_THEM BOARD_WHITE
+#define SIDE_PAWN cpBPAWN
+#define SIDE_KING cpBKING
+#define SIDE_KING_AT bking
+#define SIDE_PUSH 1
+#define SIDE_START_ROW 1
+#define SIDE_LAST_ROW BOARD_ROW_7
+#define SIDE_MORPH_FIRST cpBQUEEN
+#define SIDE_MORPH_LAST cpBROOK
+#include "board_side.inc"
+#undef SIDE
+#undef SIDE_US
+#undef SIDE_THEM
+#undef SIDE_PAWN
+#undef SIDE_KING
+#undef SIDE_KING_AT
+#undef SIDE_PUSH
+#undef SIDE_START_ROW
+#undef SIDE_LAST_ROW
+#undef SIDE_MORPH_FIRST
+#undef SIDE_MORPH_LAST
+
 piece_t board_get_at(board_p B, coord_p C)
 {
-    return B->board[8 * C->row + C->col];
+    return B->board[board_cell(board_square(C))];
 }
 
 void board_set_at(board_p B, coord_p C, piece_t p)
 {
-    B->board[8 * C->row + C->col] = p;
+    int     sq  = board_square(C);
+    piece_t old = board_at(B, sq);
+
+    /* A piece replacing one of the same colour takes its place in the list */
+    if (old != cpEEMPTY && (p == cpEEMPTY || (old ^ p) < 0))
+        board_list_remove(B, sq);
+
+    board_put(B, sq, p);
+
+    if (p != cpEEMPTY && (old == cpEEMPTY || (old ^ p) < 0))
+        board_list_add(B, sq);
 }
 
 void board_init(board_p B)
 {
-    memcpy(B->board, DEFAULT_BOARD, sizeof(DEFAULT_BOARD));
+    int sq;
+
+    board_clear(B);
+    for (sq = 0; sq < 64; ++sq)
+        board_put(B, sq, DEFAULT_BOARD[sq]);
 
     B->wking.row = 7;
     B->wking.col = 4;
     B->bking.row = 0;
     B->bking.col = 4;
+
+    board_index(B);
 }
 
-void board_print(board_p B)
+piece_t board_at(board_p B, int sq)
+{
+    return B->board[board_cell(sq)];
+}
+
+void board_put(board_p B, int sq, piece_t p)
+{
+    B->board[board_cell(sq)] = p;
+}
+
+void board_clear(board_p B)
+{
+    memset(B->board, cpEEMPTY, sizeof(B->board));
+}
+
+myuint64_t board_mask(board_p B, piece_t p)
+{
+    return board_scan(B, BOARD_SCAN_EQ, p);
+}
+
+myuint64_t board_colour_mask(board_p B, int colour)
+{
+    return board_scan(
+        B, colour == BOARD_WHITE ? BOARD_SCAN_GT : BOARD_SCAN_LT, cpEEMPTY
+    );
+}
+
+void board_pack(board_p B, board_packed_p P)
+{
+#ifdef __SSE2__
+    __m128i zero  = _mm_setzero_si128();
+    __m128i eight = _mm_set1_epi8(8);
+    __m128i v;
+    __m128i neg;
+    int     i;
+
+    /* Two rows at a time */
+    for (i = 0; i < 4; ++i)
+    {
+#ifdef BOARD_0X88
+        v = _mm_unpacklo_epi64(
+            _mm_loadl_epi64((const __m128i*)(B->board + 32 * i)),
+            _mm_loadl_epi64((const __m128i*)(B->board + 32 * i + 16))
+        );
+#else
+        v = _mm_loadu_si128((const __m128i*)(B->board + 16 * i));
+#endif
+
+        /* The kind, with 8 for black */
+        neg = _mm_cmplt_epi8(v, zero);
+        v   = _mm_sub_epi8(_mm_xor_si128(v, neg), neg);
+        v   = _mm_or_si128(v, _mm_and_si128(neg, eight));
+
+        /* Square 2 * j, the low byte of lane j, to the high nibble */
+        v = _mm_or_si128(_mm_slli_epi16(v, 4), _mm_srli_epi16(v, 8));
+        v = _mm_and_si128(v, _mm_set1_epi16(0xFF));
+        _mm_storel_epi64((__m128i*)(P->sq + 8 * i), _mm_packus_epi16(v, v));
+    }
+#else
+    int sq;
+    int high;
+    int low;
+
+    for (sq = 0; sq < 64; sq += 2)
+    {
+        high = board_at(B, sq);
+        low  = board_at(B, sq + 1);
+
+        /* The kind, with 8 for black */
+        high = high < 0 ? 8 | -high : high;
+        low  = low < 0 ? 8 | -low : low;
+
+        P->sq[sq / 2] = (myuint8_t)(high << 4 | low);
+    }
+#endif
+}
+
+const char* board_unpack(board_p B, const struct board_packed_t* P)
+{
+    struct board_t tmp;
+#ifdef __SSE2__
+    __m128i zero    = _mm_setzero_si128();
+    __m128i seven   = _mm_set1_epi8(7);
+    __m128i eight   = _mm_set1_epi8(8);
+    __m128i fifteen = _mm_set1_epi16(0x0F);
+    __m128i bad     = zero;
+    __m128i v;
+    __m128i kind;
+    __m128i neg;
+    int     i;
+#else
+    int sq;
+    int nibble;
+    int kind;
+#endif
+
+    board_clear(&tmp);
+
+#ifdef __SSE2__
+    /* Two rows at a time */
+    for (i = 0; i < 4; ++i)
+    {
+        /* A lane per byte: the high nibble to the low byte */
+        v = _mm_unpacklo_epi8(
+            _mm_loadl_epi64((const __m128i*)(P->sq + 8 * i)), zero
+        );
+        v = _mm_or_si128(
+            _mm_srli_epi16(v, 4), _mm_slli_epi16(_mm_and_si128(v, fifteen), 8)
+        );
+
+        /* 7 is not a piece kind and 8 would be a black empty square */
+        kind = _mm_and_si128(v, seven);
+        bad  = _mm_or_si128(bad, _mm_cmpeq_epi8(kind, seven));
+        bad  = _mm_or_si128(bad, _mm_cmpeq_epi8(v, eight));
+
+        neg  = _mm_cmpeq_epi8(_mm_and_si128(v, eight), eight);
+        v    = _mm_sub_epi8(_mm_xor_si128(kind, neg), neg);
+
+#ifdef BOARD_0X88
+        _mm_storel_epi64((__m128i*)(tmp.board + 32 * i), v);
+        _mm_storel_epi64(
+            (__m128i*)(tmp.board + 32 * i + 16), _mm_srli_si128(v, 8)
+        );
+#else
+        _mm_storeu_si128((__m128i*)(tmp.board + 16 * i), v);
+#endif
+    }
+
+    if (_mm_movemask_epi8(bad) != 0)
+        return BOARD_PACKED_ERR_PIECE;
+#else
+    for (sq = 0; sq < 64; ++sq)
+    {
+        /* Even squares are stored in the high nibble */
+        nibble = sq & 1 ? P->sq[sq / 2] & 0x0F : P->sq[sq / 2] >> 4;
+        kind   = nibble & 7;
+
+        /* 7 is not a piece kind and 8 would be a black empty square */
+        if (kind == 7 || nibble == 8)
+            return BOARD_PACKED_ERR_PIECE;
+
+        board_put(&tmp, sq, (piece_t)(nibble & 8 ? -kind : kind));
+    }
+#endif
+
+    if (!board_find_king(&tmp, cpWKING, &tmp.wking) ||
+        !board_find_king(&tmp, cpBKING, &tmp.bking))
+        return BOARD_PACKED_ERR_KING;
+
+    board_index(&tmp);
+    *B = tmp;
+
+    return NULL;
+}
+
+const char* board_backend(void)
+{
+#ifdef BOARD_0X88
+    return "0x88";
+#else
+    return "mailbox";
+#endif
+}
+
+void board_index(board_p B)
+{
+    myuint64_t pieces;
+
+    B->count[BOARD_WHITE]    = 0;
+    B->count[BOARD_BLACK]    = 0;
+    B->occupied[BOARD_WHITE] = 0;
+    B->occupied[BOARD_BLACK] = 0;
+
+    /* In board order, as the lists of a new board have always been */
+    for (pieces = ~board_mask(B, cpEEMPTY); pieces != 0; pieces &= pieces - 1)
+        board_list_add(B, attack_first(pieces));
+}
+
+/* Position in list of the i-th piece of colour */
+static int board_list_slot(int colour, int i)
+{
+    return colour == BOARD_WHITE ? i : 63 - i;
+}
+
+/* Append sq, that must hold a piece, to the list of its colour */
+static void board_list_add(board_p B, int sq)
+{
+    int colour = board_at(B, sq) < 0 ? BOARD_BLACK : BOARD_WHITE;
+    int i      = B->count[colour]++;
+
+    B->index[sq]                        = (myuint8_t)i;
+    B->list[board_list_slot(colour, i)] = (myuint8_t)sq;
+    B->occupied[colour] |= attack_bit(sq);
+}
+
+/* Take sq, that must still hold its piece, out of the list of its colour:
+ * the last piece of the list takes its position */
+static void board_list_remove(board_p B, int sq)
+{
+    int colour = board_at(B, sq) < 0 ? BOARD_BLACK : BOARD_WHITE;
+    int last   = --B->count[colour];
+    int moved  = B->list[board_list_slot(colour, last)];
+
+    B->list[board_list_slot(colour, B->index[sq])] = (myuint8_t)moved;
+    B->index[moved]                                = B->index[sq];
+    B->occupied[colour] &= ~attack_bit(sq);
+}
+
+/* Copy the squares of the pieces of colour into sq (64 at most), in board
+ * order: lists are changed by simulated moves while the copy is walked, and
+ * moves are listed in the same order whatever the history of the board.
+ *
+ * RETURN
+ * The number of squares copied.
+ */
+static int board_pieces(board_p B, int colour, int* sq)
+{
+    int n = B->count[colour];
+    int tmp;
+    int i;
+    int j;
+
+    for (i = 0; i < n; ++i)
+    {
+        tmp = B->list[board_list_slot(colour, i)];
+
+        for (j = i; j > 0 && sq[j - 1] > tmp; --j)
+            sq[j] = sq[j - 1];
+
+        sq[j] = tmp;
+    }
+
+    return n;
+}
+
+static int board_square(coord_p C)
+{
+    return 8 * C->row + C->col;
+}
+
+/* Cell of struct board_t.board holding square sq (see BOARD_CELLS) */
+static int board_cell(int sq)
+{
+#ifdef BOARD_0X88
+    return sq + (sq & ~7);
+#else
+    return sq;
+#endif
+}
+
+/* RETURN
+ * Whether the square rows rows and cols columns away from sq (a step of a
+ * piece, each of them in -7 .. 7) is off the board.
+ */
+static int board_step_off(int sq, int rows, int cols)
+{
+    return BOARD_OFF(sq / 8 + rows, sq % 8 + cols);
+}
+
+static int board_find_king(board_p B, piece_t king, coord_p C)
+{
+    myuint64_t kings = board_mask(B, king);
+
+    C->row = C->col = -1;
+
+    if (kings == 0)
+        return 1;
+
+    if (kings & (kings - 1))
+        return 0;
+
+    C->row = (myint8_t)(attack_first(kings) / 8);
+    C->col = (myint8_t)(attack_first(kings) % 8);
+
+    return 1;
+}
+
+/* RETURN
+ * The squares whose piece compares to p as told by cmp (BOARD_SCAN_*).
+ *
+ * The cells are compared a vector at a time where the build has vectors
+ * (SSE2 on any x86-64, AVX2 with -DAVX2), a byte of the movemask standing
+ * for a cell: the padding of the 0x88 layout is dropped from it.
+ */
+static myuint64_t board_scan(board_p B, int cmp, piece_t p)
+{
+    myuint64_t mask = 0;
+    int        i;
+#if defined(AVX2)
+    __m256i    ref = _mm256_set1_epi8((char)p);
+    __m256i    v;
+    myuint64_t bits;
+
+    for (i = 0; i < BOARD_CELLS / 32; ++i)
+    {
+        v = _mm256_loadu_si256((const __m256i*)(B->board + 32 * i));
+
+        if (cmp == BOARD_SCAN_EQ)
+            v = _mm256_cmpeq_epi8(v, ref);
+        else if (cmp == BOARD_SCAN_GT)
+            v = _mm256_cmpgt_epi8(v, ref);
+        else
+            v = _mm256_cmpgt_epi8(ref, v);
+
+        bits = (myuint32_t)_mm256_movemask_epi8(v);
+#ifdef BOARD_0X88
+        /* Two rows of 16 cells */
+        mask |= ((bits & 0xFF) | ((bits >> 8) & 0xFF00)) << (16 * i);
+#else
+        mask |= bits << (32 * i);
+#endif
+    }
+#elif defined(__SSE2__)
+    __m128i    ref = _mm_set1_epi8((char)p);
+    __m128i    v;
+    myuint64_t bits;
+
+    for (i = 0; i < BOARD_CELLS / 16; ++i)
+    {
+        v = _mm_loadu_si128((const __m128i*)(B->board + 16 * i));
+
+        if (cmp == BOARD_SCAN_EQ)
+            v = _mm_cmpeq_epi8(v, ref);
+        else if (cmp == BOARD_SCAN_GT)
+            v = _mm_cmpgt_epi8(v, ref);
+        else
+            v = _mm_cmplt_epi8(v, ref);
+
+        bits = (myuint32_t)_mm_movemask_epi8(v);
+#ifdef BOARD_0X88
+        /* A row of 16 cells */
+        mask |= (bits & 0xFF) << (8 * i);
+#else
+        mask |= bits << (16 * i);
+#endif
+    }
+#else
+    piece_t c;
+    int     hit;
+
+    for (i = 0; i < 64; ++i)
+    {
+        c = board_at(B, i);
+
+        if (cmp == BOARD_SCAN_EQ)
+            hit = c == p;
+        else if (cmp == BOARD_SCAN_GT)
+            hit = c > p;
+        else
+            hit = c < p;
+
+        if (hit)
+            mask |= attack_bit(i);
+    }
+#endif
+
+    return mask;
+}
+
+static myuint64_t board_occupied(board_p B)
+{
+    return B->occupied[BOARD_WHITE] | B->occupied[BOARD_BLACK];
+}
+
+void board_print(board_p B, FILE* fp)
 {
     struct coord_t coord;
 
-    printf("\n    ");
+    fprintf(fp, "\n    ");
     for (coord.col = 0; coord.col < 8; ++coord.col)
-        printf("%c ", 'A' + coord.col);
-    printf("\n");
+        fprintf(fp, "%c ", 'A' + coord.col);
+    fprintf(fp, "\n");
 
     for (coord.row = 0; coord.row < 8; ++coord.row)
     {
-        printf("\n%d   ", 8 - coord.row);
+        fprintf(fp, "\n%d   ", 8 - coord.row);
         for (coord.col = 0; coord.col < 8; ++coord.col)
         {
             piece_t p = board_get_at(B, &coord);
-            printf("%s%c\x1b[0m ", board_colour(&coord), piece_to_char(p));
+            fprintf(
+                fp, "%s%c\x1b[0m ", board_colour(&coord), piece_to_char(p)
+            );
+        }
+    }
+
+    fprintf(fp, "\n\n");
+}
+
+const char*
+board_from_fen(board_p B, turn_t* turn, const char* fen, const char** end)
+{
+    struct board_t tmp;
+    turn_t         tmp_turn;
+    const char*    err;
+    const char*    cur;
+    int            clock;
+
+    cur = board_fen_placement(&tmp, move_to_not_blank(fen), &err);
+    if (cur == NULL)
+        return err;
+
+    cur = move_to_not_blank(cur);
+    switch (*cur)
+    {
+    case 'w':
+        tmp_turn = cpWTURN;
+        break;
+    case 'b':
+        tmp_turn = cpBTURN;
+        break;
+    default:
+        return BOARD_FEN_ERR_TURN;
+    }
+
+    ++cur;
+    if (*cur && *cur != ' ')
+        return BOARD_FEN_ERR_TURN;
+
+    /* Castling availability: "-" or any of KQkq */
+    cur = move_to_not_blank(cur);
+    cur = *cur == '-' ? board_fen_skip_field(cur + 1, "")
+                      : board_fen_skip_field(cur, "KQkq");
+    if (cur == NULL)
+        return BOARD_FEN_ERR_CASTLING;
+
+    /* En passant target square: "-" or a square on the 3rd or 6th rank */
+    cur = move_to_not_blank(cur);
+    if (*cur == '-')
+        cur = board_fen_skip_field(cur + 1, "");
+    else if (*cur && *cur >= 'a' && *cur <= 'h' &&
+             (cur[1] == '3' || cur[1] == '6'))
+        cur = board_fen_skip_field(cur + 2, "");
+    else if (*cur)
+        cur = NULL;
+
+    if (cur == NULL)
+        return BOARD_FEN_ERR_EN_PASSANT;
+
+    /* Halfmove clock and fullmove number, if any: EPD operations may follow
+     * the en passant target square instead */
+    for (clock = 0; clock < 2; ++clock)
+    {
+        if (!isdigit((unsigned char)*move_to_not_blank(cur)))
+            break;
+
+        cur = board_fen_skip_field(move_to_not_blank(cur), "0123456789");
+        if (cur == NULL)
+            return BOARD_FEN_ERR_CLOCK;
+    }
+
+    if (end != NULL)
+        *end = cur;
+    else if (*move_to_not_blank(cur))
+        return BOARD_FEN_ERR_TRAILING;
+
+    *B    = tmp;
+    *turn = tmp_turn;
+
+    return NULL;
+}
+
+size_t board_to_fen(board_p B, turn_t turn, char* buf, size_t n)
+{
+    const char* tail;
+    size_t      cur;
+    size_t      sq;
+    int         empty;
+
+    /* Worst case: every square is a piece and tail is appended */
+    if (n < BOARD_FEN_LENGTH)
+        return 0;
+
+    cur   = 0;
+    empty = 0;
+    for (sq = 0; sq < 64; ++sq)
+    {
+        if (board_at(B, (int)sq) == cpEEMPTY)
+        {
+            ++empty;
+        }
+        else
+        {
+            if (empty)
+                buf[cur++] = (char)('0' + empty);
+            empty      = 0;
+            buf[cur++] = piece_to_char(board_at(B, (int)sq));
+        }
+
+        if (sq % 8 == 7)
+        {
+            if (empty)
+                buf[cur++] = (char)('0' + empty);
+            empty = 0;
+
+            if (sq != 63)
+                buf[cur++] = '/';
+        }
+    }
+
+    tail = turn == cpWTURN ? " w - - 0 1" : " b - - 0 1";
+    strcpy(buf + cur, tail);
+
+    return cur + strlen(tail);
+}
+
+static const char*
+board_fen_placement(board_p B, const char* fen, const char** err)
+{
+    piece_t p;
+    int     row;
+    int     col;
+
+    B->wking.row = B->wking.col = -1;
+    B->bking.row = B->bking.col = -1;
+    board_clear(B);
+
+    *err = BOARD_FEN_ERR_PLACEMENT;
+    row  = 0;
+    col  = 0;
+
+    for (; *fen && *fen != ' '; ++fen)
+    {
+        if (*fen == '/')
+        {
+            if (col != 8 || row == 7)
+                return NULL;
+
+            ++row;
+            col = 0;
+        }
+        else if (*fen >= '1' && *fen <= '8')
+        {
+            if (col + (*fen - '0') > 8)
+                return NULL;
+
+            for (p = (piece_t)(*fen - '0'); p > 0; --p)
+                board_put(B, 8 * row + col++, cpEEMPTY);
+        }
+        else
+        {
+            /* Upper case for white, lower case for black */
+            p = piece_from_char(*fen, *fen >= 'a' ? cpBTURN : cpWTURN);
+            if (p == cpEEMPTY || col == 8)
+                return NULL;
+
+            if (p == cpWKING || p == cpBKING)
+            {
+                coord_p king = p == cpWKING ? &B->wking : &B->bking;
+
+                if (king->row != -1)
+                {
+                    *err = BOARD_FEN_ERR_KING;
+                    return NULL;
+                }
+
+                king->row = (myint8_t)row;
+                king->col = (myint8_t)col;
+            }
+
+            board_put(B, 8 * row + col++, p);
         }
     }
 
-    printf("\n\n");
+    if (row != 7 || col != 8)
+        return NULL;
+
+    board_index(B);
+
+    *err = NULL;
+    return fen;
+}
+
+static const char* board_fen_skip_field(const char* fen, const char* accept)
+{
+    for (; *fen && *fen != ' '; ++fen)
+        if (strchr(accept, *fen) == NULL)
+            return NULL;
+
+    return fen;
 }
 
 static const char* board_check_move_direction(board_p B, move_p M, turn_t turn)
@@ -212,6 +897,7 @@ const char* board_check_move(
 )
 {
     const char*    err_direction;
+    const char*    err;
     piece_t        o_src;
     piece_t        o_dst;
     struct coord_t o_wking;
@@ -230,7 +916,14 @@ const char* board_check_move(
         !(pawn_morph < -1 && pawn_morph > -6))
         return ILLEGAL_MOVE_PAWN_MORPH;
 
-    /* Save the original pieces and simulate execution */
+    /* Fast path: checks and pins from the tables (see board_check_king).
+     * Boards it does not apply to (a custom game without the king where the
+     * board says) are simulated */
+    if (turn > 0 ? board_check_king_WHITE(B, M, whence, &err)
+                 : board_check_king_BLACK(B, M, whence, &err))
+        return err;
+
+    /* Slow path: save the original pieces and simulate execution */
     o_src = board_get_at(B, &M->source);
     o_dst = board_get_at(B, &M->dest);
 
@@ -353,50 +1046,10 @@ static const char* board_is_illegal_PAWN_move(board_p B, move_p M)
 
 static const char* board_is_illegal_ROOK_move(board_p B, move_p M)
 {
-    struct coord_t ctmp; /* Coord to iterate on */
-    myint8_t*
-        coord_cur; /* Coord cursor; When iterating on the board using ctmp, one
-                      coordinate is constant (col or row) and the other one is
-                      variable. This is a pointer to the latter */
-    myint8_t incr; /* 1 is the move goes up, -1 if goes down */
-    myint8_t actual_offset; /* The value of the actual offset */
-    myint8_t move_bound;    /* Index of destination row or col */
-
-    /* Moving both horizontally and vertically
-     * No need to check if both are zero because it would be a non-move
-     */
-    if (M->offset.row != 0 && M->offset.col != 0)
+    /* Along a row or a column, nothing in between */
+    if ((M->offset.row != 0 && M->offset.col != 0) || board_path_blocked(B, M))
         return ILLEGAL_MOVE_ROOK_DESC;
 
-    if (M->offset.col != 0)
-    {
-        ctmp.row      = M->source.row;
-        incr          = M->offset.col > 0 ? 1 : -1;
-        coord_cur     = &ctmp.col;
-        *coord_cur    = M->source.col;
-        actual_offset = M->offset.col;
-        move_bound    = M->dest.col;
-    }
-    else
-    {
-        ctmp.col      = M->source.col;
-        incr          = M->offset.row > 0 ? 1 : -1;
-        coord_cur     = &ctmp.row;
-        *coord_cur    = M->source.row;
-        actual_offset = M->offset.row;
-        move_bound    = M->dest.row;
-    }
-
-    *coord_cur = (myint8_t)(*coord_cur + incr);
-    while ((actual_offset > 0 && *coord_cur < move_bound) ||
-           (actual_offset < 0 && *coord_cur > move_bound))
-    {
-        if (board_get_at(B, &ctmp) != cpEEMPTY)
-            /* Trying to jump a piece */
-            return ILLEGAL_MOVE_ROOK_DESC;
-        *coord_cur = (myint8_t)(*coord_cur + incr);
-    }
-
     return NULL;
 }
 
@@ -404,19 +1057,8 @@ static const char* board_is_illegal_KNIGHT_move(board_p B, move_p M)
 {
     (void)B;
 
-    if (M->abs_offset.row > 2 || M->abs_offset.row == 0)
-        return ILLEGAL_MOVE_KNIGHT_DESC;
-
-    if (M->abs_offset.col > 2 || M->abs_offset.col == 0)
-        return ILLEGAL_MOVE_KNIGHT_DESC;
-
-    if (M->abs_offset.row == 2 && M->abs_offset.col == 2)
-        return ILLEGAL_MOVE_KNIGHT_DESC;
-
-    if (M->abs_offset.row == 1 && M->abs_offset.col != 2)
-        return ILLEGAL_MOVE_KNIGHT_DESC;
-
-    if (M->abs_offset.col == 1 && M->abs_offset.row != 2)
+    if (!(attack_knights[board_square(&M->source)] &
+          attack_bit(board_square(&M->dest))))
         return ILLEGAL_MOVE_KNIGHT_DESC;
 
     return NULL;
@@ -424,56 +1066,32 @@ static const char* board_is_illegal_KNIGHT_move(board_p B, move_p M)
 
 static const char* board_is_illegal_BISHOP_move(board_p B, move_p M)
 {
-    struct coord_t ctmp;   /* Coord to iterate on */
-    int            incr_r; /* Increment on row (1 or -1, based on M) */
-    int            incr_c; /* Increment on col (1 or -1, based on M) */
-
-    if (M->abs_offset.row != M->abs_offset.col)
+    /* As for the rook, on the diagonals */
+    if (M->abs_offset.row != M->abs_offset.col || board_path_blocked(B, M))
         return ILLEGAL_MOVE_BISHOP_DESC;
 
-    incr_r   = M->offset.row > 0 ? 1 : -1;
-    incr_c   = M->offset.col > 0 ? 1 : -1;
-    ctmp     = M->source;
-
-    ctmp.row = (myint8_t)(ctmp.row + incr_r);
-    ctmp.col = (myint8_t)(ctmp.col + incr_c);
-
-    /* The condition could be based both on row and col, but since row and col
-     * get incremented together, there is no point in checking both */
-    while ((incr_r > 0 && ctmp.row < M->dest.row) ||
-           (incr_r < 0 && ctmp.row > M->dest.row))
-    {
-        if (board_get_at(B, &ctmp) != cpEEMPTY)
-            return ILLEGAL_MOVE_BISHOP_DESC;
-
-        ctmp.row = (myint8_t)(ctmp.row + incr_r);
-        ctmp.col = (myint8_t)(ctmp.col + incr_c);
-    }
-
     return NULL;
 }
 
 static const char* board_is_illegal_QUEEN_move(board_p B, move_p M)
 {
-    const char* err;
-
-    err = board_is_illegal_ROOK_move(B, M);
-    if (err == NULL)
-        return NULL;
+    /* The line is 0 if the squares share none */
+    if (attack_line[board_square(&M->source)][board_square(&M->dest)] == 0 ||
+        board_path_blocked(B, M))
+        return ILLEGAL_MOVE_QUEEN_DESC;
 
-    err = board_is_illegal_BISHOP_move(B, M);
-    if (err == NULL)
-        return NULL;
+    return NULL;
+}
 
-    return ILLEGAL_MOVE_QUEEN_DESC;
+static int board_path_blocked(board_p B, move_p M)
+{
+    return (attack_between[board_square(&M->source)][board_square(&M->dest)] &
+            board_occupied(B)) != 0;
 }
 
 static const char* board_is_illegal_KING_move(board_p B, move_p M)
 {
-    if (M->abs_offset.row > 1)
-        return ILLEGAL_MOVE_KING_DESC;
-
-    if (M->abs_offset.col > 1)
+    if (attack_distance[board_square(&M->source)][board_square(&M->dest)] > 1)
         return ILLEGAL_MOVE_KING_DESC;
 
     if (board_get_at(B, &M->dest) != cpEEMPTY)
@@ -484,12 +1102,7 @@ static const char* board_is_illegal_KING_move(board_p B, move_p M)
 
 int board_coord_out_of_bound(coord_p C)
 {
-    if (C->row < 0 || C->row > 7)
-        return 1;
-    if (C->col < 0 || C->col > 7)
-        return 1;
-
-    return 0;
+    return BOARD_OFF(C->row, C->col);
 }
 
 void board_exec(board_p B, move_p M, piece_t pawn_morph)
@@ -512,6 +1125,20 @@ void board_exec(board_p B, move_p M, piece_t pawn_morph)
         B->bking = M->dest;
 }
 
+void board_exec16(board_p B, move16_t m)
+{
+    struct move_t M;
+    piece_t       pawn_morph;
+
+    move16_unpack(
+        m,
+        board_at(B, move16_source(m)) < 0 ? cpBTURN : cpWTURN,
+        &M,
+        &pawn_morph
+    );
+    board_exec(B, &M, pawn_morph);
+}
+
 static const char* board_colour(coord_p C)
 {
     /* I'm only interested in whether row and col are odd or even */
@@ -529,153 +1156,112 @@ static const char* board_colour(coord_p C)
 void board_under_check_part(board_p B, coord_p king, coord_p whence)
 {
     struct move_t mtmp;
-    const char*   is_illegal_move;
-    piece_t       src;
+    myuint8_t*    attackers;
+    myuint64_t    lines;
+    myuint64_t    diagonals;
     piece_t       dst;
+    piece_t       src;
+    int           hit;
+    int           n;
+    int           first;
+    int           i;
+
+    /* No king, no check */
+    if (board_coord_out_of_bound(king))
+        return;
 
     mtmp.dest = *king;
     dst       = board_get_at(B, king);
 
-    for (mtmp.source.row = 0; mtmp.source.row < 8; ++mtmp.source.row)
-        for (mtmp.source.col = 0; mtmp.source.col < 8; ++mtmp.source.col)
-        {
-            /* Not a move */
-            if (coord_eq(&mtmp.source, king))
-                continue;
+    /* The pieces of the other player (black ones if king is empty) */
+    if (dst < 0)
+    {
+        attackers = B->list;
+        n         = B->count[BOARD_WHITE];
+    }
+    else
+    {
+        attackers = B->list + 64 - B->count[BOARD_BLACK];
+        n         = B->count[BOARD_BLACK];
+    }
 
-            /* Dest empty or same player */
-            src = board_get_at(B, &mtmp.source);
-            if (src == cpEEMPTY || (src ^ dst) > 0)
-                continue;
+    /* A slider attacks the king if the king, as the same slider, would
+     * attack it back */
+    lines     = attack_rook(board_square(king), board_occupied(B));
+    diagonals = attack_bishop(board_square(king), board_occupied(B));
 
-            move_set_offset(&mtmp);
+    /* Whence is the first attacker in board order, whatever the list order */
+    first     = 64;
+    for (i = 0; i < n; ++i)
+    {
+        if (attackers[i] > first)
+            continue;
 
-            is_illegal_move = board_check_move_direction(B, &mtmp, (turn_t)src);
-            if (is_illegal_move == NULL)
+        src = board_at(B, attackers[i]);
+        switch (src < 0 ? -src : src)
+        {
+        case cpWROOK:
+            hit = (lines & attack_bit(attackers[i])) != 0;
+            break;
+        case cpWBISHOP:
+            hit = (diagonals & attack_bit(attackers[i])) != 0;
+            break;
+        case cpWQUEEN:
+            hit = ((lines | diagonals) & attack_bit(attackers[i])) != 0;
+            break;
+        case cpWKNIGHT:
+            hit = (attack_knights[board_square(king)] &
+                   attack_bit(attackers[i])) != 0;
+            break;
+        case cpWPAWN:
+            /* On an empty square a pawn could also be pushed: see default */
+            if (dst != cpEEMPTY)
             {
-                *whence = mtmp.source;
-                return;
+                hit = (attack_pawns[src < 0][attackers[i]] &
+                       attack_bit(board_square(king))) != 0;
+                break;
             }
-        }
-}
-
-int board_dump(board_p B, FILE* fp)
-{
-    size_t nw;
-
-    nw = fwrite(B, 1, sizeof(struct board_t), fp);
-    if (nw != sizeof(struct board_t))
-        return 0;
-
-    return 1;
-}
+            /* FALLTHROUGH */
+        default:
+            mtmp.source.row = (myint8_t)(attackers[i] / 8);
+            mtmp.source.col = (myint8_t)(attackers[i] % 8);
 
-int board_restore(board_p B, FILE* fp)
-{
-    size_t nr;
-
-    nr = fread(B, 1, sizeof(struct board_t), fp);
-    if (nr != sizeof(struct board_t))
-        return 0;
-
-    return 1;
-}
-
-static size_t
-board_list_PAWN_moves(board_p B, coord_p src, coord_p dst, size_t n)
-{
-    piece_t        src_piece;
-    struct coord_t possible_dst;
-    myint8_t       incr;
-    size_t         cur;
-
-    cur = 0;
-    assert_return(n > cur, cur);
-
-    src_piece    = board_get_at(B, src);
-    incr         = board_get_at(B, src) > 0 ? -1 : 1;
-    possible_dst = *src;
-
-    /* Advance by one only if destination is empty */
-    possible_dst.row = (myint8_t)(possible_dst.row + incr);
-    if (!board_coord_out_of_bound(&possible_dst) &&
-        board_get_at(B, &possible_dst) == cpEEMPTY)
-    {
-        dst[cur++] = possible_dst;
-        assert_return(n > cur, cur);
-    }
+            /* Not a move */
+            if (coord_eq(&mtmp.source, king))
+                continue;
 
-    /* If PAWN is in initial position, let's check if it can advance by two */
-    if ((src->row == 1 && incr == 1) || (src->row == 6 && incr == -1))
-    {
-        possible_dst.row = (myint8_t)(possible_dst.row + incr);
-        if (!board_coord_out_of_bound(&possible_dst) &&
-            board_get_at(B, &possible_dst) == cpEEMPTY)
-        {
-            dst[cur++] = possible_dst;
-            assert_return(n > cur, cur);
+            move_set_offset(&mtmp);
+            hit = board_check_move_direction(B, &mtmp, (turn_t)src) == NULL;
+            break;
         }
 
-        /* Get back! */
-        possible_dst.row = (myint8_t)(possible_dst.row - incr);
+        if (hit)
+            first = attackers[i];
     }
 
-    /* Now src is the original src + incr;
-     * Let's see if PAWN can take over something
-     */
-    possible_dst.col = (myint8_t)(possible_dst.col + 1);
-    if (!board_coord_out_of_bound(&possible_dst) &&
-        board_get_at(B, &possible_dst) != cpEEMPTY &&
-        (board_get_at(B, &possible_dst) ^ src_piece) < 0)
+    if (first != 64)
     {
-        dst[cur++] = possible_dst;
-        assert_return(n > cur, cur);
+        whence->row = (myint8_t)(first / 8);
+        whence->col = (myint8_t)(first % 8);
     }
-
-    possible_dst.col = (myint8_t)(possible_dst.col - 2);
-    if (!board_coord_out_of_bound(&possible_dst) &&
-        board_get_at(B, &possible_dst) != cpEEMPTY &&
-        (board_get_at(B, &possible_dst) ^ src_piece) < 0)
-        dst[cur++] = possible_dst;
-
-    return cur;
 }
 
-static size_t board_list_ANY_STRAIGHT_moves(
-    board_p B, coord_p src, coord_p incr, coord_p dst, size_t n
+static size_t board_list_targets(
+    board_p B, coord_p src, myuint64_t targets, coord_p dst, size_t n
 )
 {
-    struct coord_t candidate;
-    piece_t        src_piece;
-    size_t         cur;
-
-    assert_return(n > 0, 0);
-    cur           = 0;
-    candidate     = *src;
-
-    src_piece     = board_get_at(B, src);
+    size_t cur;
+    int    sq;
 
-    candidate.row = (myint8_t)(candidate.row + incr->row);
-    candidate.col = (myint8_t)(candidate.col + incr->col);
+    targets &=
+        ~B->occupied[board_get_at(B, src) < 0 ? BOARD_BLACK : BOARD_WHITE];
 
-    while (!board_coord_out_of_bound(&candidate) && cur < n)
+    for (cur = 0; targets != 0 && cur < n; ++cur)
     {
-        if (board_get_at(B, &candidate) == cpEEMPTY)
-        {
-            dst[cur++] = candidate;
-        }
-        else if ((board_get_at(B, &candidate) ^ src_piece) < 0)
-        {
-            dst[cur++] = candidate;
-            break;
-        }
-        else
-        {
-            break;
-        }
-
-        candidate.row = (myint8_t)(candidate.row + incr->row);
-        candidate.col = (myint8_t)(candidate.col + incr->col);
+        sq           = attack_first(targets);
+        dst[cur].row = (myint8_t)(sq / 8);
+        dst[cur].col = (myint8_t)(sq % 8);
+        targets &= targets - 1;
     }
 
     return cur;
@@ -684,188 +1270,49 @@ static size_t board_list_ANY_STRAIGHT_moves(
 static size_t
 board_list_ROOK_moves(board_p B, coord_p src, coord_p dst, size_t n)
 {
-    struct coord_t incr;
-    size_t         cur;
-
     assert_return(n > 0, 0);
-    cur      = 0;
-
-    incr.row = 1;
-    incr.col = 0;
-    cur += board_list_ANY_STRAIGHT_moves(B, src, &incr, dst + cur, n - cur);
-
-    incr.row = -1;
-    incr.col = 0;
-    cur += board_list_ANY_STRAIGHT_moves(B, src, &incr, dst + cur, n - cur);
-
-    incr.row = 0;
-    incr.col = 1;
-    cur += board_list_ANY_STRAIGHT_moves(B, src, &incr, dst + cur, n - cur);
 
-    incr.row = 0;
-    incr.col = -1;
-    cur += board_list_ANY_STRAIGHT_moves(B, src, &incr, dst + cur, n - cur);
-
-    return cur;
+    return board_list_targets(
+        B, src, attack_rook(board_square(src), board_occupied(B)), dst, n
+    );
 }
 
 static size_t
 board_list_BISHOP_moves(board_p B, coord_p src, coord_p dst, size_t n)
 {
-    struct coord_t incr;
-    size_t         cur;
-
     assert_return(n > 0, 0);
-    cur      = 0;
-
-    incr.row = 1;
-    incr.col = 1;
-    cur += board_list_ANY_STRAIGHT_moves(B, src, &incr, dst + cur, n - cur);
-
-    incr.row = 1;
-    incr.col = -1;
-    cur += board_list_ANY_STRAIGHT_moves(B, src, &incr, dst + cur, n - cur);
 
-    incr.row = -1;
-    incr.col = 1;
-    cur += board_list_ANY_STRAIGHT_moves(B, src, &incr, dst + cur, n - cur);
-
-    incr.row = -1;
-    incr.col = -1;
-    cur += board_list_ANY_STRAIGHT_moves(B, src, &incr, dst + cur, n - cur);
-
-    return cur;
+    return board_list_targets(
+        B, src, attack_bishop(board_square(src), board_occupied(B)), dst, n
+    );
 }
 
 static size_t
 board_list_QUEEN_moves(board_p B, coord_p src, coord_p dst, size_t n)
 {
-    size_t cur;
-
     assert_return(n > 0, 0);
-    cur = 0;
-
-    cur += board_list_ROOK_moves(B, src, dst + cur, n - cur);
-    cur += board_list_BISHOP_moves(B, src, dst + cur, n - cur);
 
-    return cur;
+    return board_list_targets(
+        B, src, attack_queen(board_square(src), board_occupied(B)), dst, n
+    );
 }
 
 static size_t
 board_list_KNIGHT_moves(board_p B, coord_p src, coord_p dst, size_t n)
 {
-    size_t         cur;
-    struct coord_t candidate;
-    piece_t        dst_piece;
-    piece_t        src_piece;
-
     assert_return(n > 0, 0);
 
-    cur       = 0;
-    src_piece = board_get_at(B, src);
-
-    /* Positions To Test
-     *
-     * Offset with respect to src
-     * ROW -- +2 -2 -2 +2 // +1 -1 -1 +1
-     * COL -- +1 +1 -1 -1 // +2 +2 -2 -2
-     *
-     * Move through the code
-     * ROW -- +2 -4 +0 +4 // -1 -2 +0 +2
-     * COL -- +1 +0 -2 -0 // +3 +0 -4 -0
-     */
-
-    candidate = *src;
-
-    /* Using a MACRO because it is a lot of replicated code:
-     * - It is ok to replicate it (the alternative would be a function in the
-     * hope that the optimizer would embed it);
-     * - It is reasonably simple.
-     */
-#define board_list_KNIGHT_moves_autogen_check(RR, CC)                          \
-    {                                                                          \
-        candidate.row = (myint8_t)(candidate.row + (RR));                      \
-        candidate.col = (myint8_t)(candidate.col + (CC));                      \
-        dst_piece     = board_get_at(B, &candidate);                           \
-        if (!board_coord_out_of_bound(&candidate))                             \
-        {                                                                      \
-            if ((dst_piece == cpEEMPTY || (dst_piece ^ src_piece) < 0))        \
-            {                                                                  \
-                dst[cur++] = candidate;                                        \
-                assert_return(n > cur, cur);                                   \
-            }                                                                  \
-        }                                                                      \
-    }
-
-    board_list_KNIGHT_moves_autogen_check(2, 1);
-    board_list_KNIGHT_moves_autogen_check(-4, 0);
-    board_list_KNIGHT_moves_autogen_check(0, -2);
-    board_list_KNIGHT_moves_autogen_check(4, 0);
-
-    board_list_KNIGHT_moves_autogen_check(-1, 3);
-    board_list_KNIGHT_moves_autogen_check(-2, 0);
-    board_list_KNIGHT_moves_autogen_check(0, -4);
-    board_list_KNIGHT_moves_autogen_check(2, 0);
-
-#undef board_list_KNIGHT_moves_autogen_check
-
-    return cur;
+    return board_list_targets(
+        B, src, attack_knights[board_square(src)], dst, n
+    );
 }
 
 static size_t
 board_list_KING_moves(board_p B, coord_p src, coord_p dst, size_t n)
 {
-    size_t         cur;
-    struct coord_t candidate;
-    piece_t        dst_piece;
-    piece_t        src_piece;
-
     assert_return(n > 0, 0);
 
-    cur           = 0;
-    src_piece     = board_get_at(B, src);
-
-    candidate.row = (myint8_t)(src->row - 1);
-    candidate.col = (myint8_t)(src->col - 1);
-
-    do
-    {
-        dst_piece = board_get_at(B, &candidate);
-        if (!board_coord_out_of_bound(&candidate))
-        {
-            if (dst_piece == cpEEMPTY || (dst_piece ^ src_piece) < 0)
-            {
-                dst[cur++] = candidate;
-                assert_return(n > cur, cur);
-            }
-        }
-
-        /* Increment Sequence
-         * ROW -1 | -1 -1  0  1  1  1  0 | -1
-         * COL -1 |  0  1  1  1  0 -1 -1 | -1
-         */
-        switch (candidate.row - src->row)
-        {
-        case -1:
-            if (candidate.col <= src->col)
-                candidate.col = (myint8_t)(candidate.col + 1);
-            else
-                candidate.row = src->row;
-            break;
-        case 0:
-            candidate.row =
-                (myint8_t)(candidate.row + candidate.col - src->col);
-            break;
-        case 1:
-            if (candidate.col >= src->col)
-                candidate.col = (myint8_t)(candidate.col - 1);
-            else
-                candidate.row = src->row;
-            break;
-        }
-    } while (candidate.row != src->row - 1 || candidate.col != src->col - 1);
-
-    return cur;
+    return board_list_targets(B, src, attack_kings[board_square(src)], dst, n);
 }
 
 int board_list_moves(board_p B, coord_p src, coord_p dst, size_t n)
@@ -878,8 +1325,9 @@ int board_list_moves(board_p B, coord_p src, coord_p dst, size_t n)
     switch (src_piece)
     {
     case cpWPAWN:
+        return (int)board_list_PAWN_moves_WHITE(B, src, dst, n);
     case cpBPAWN:
-        return (int)board_list_PAWN_moves(B, src, dst, n);
+        return (int)board_list_PAWN_moves_BLACK(B, src, dst, n);
     case cpWROOK:
     case cpBROOK:
         return (int)board_list_ROOK_moves(B, src, dst, n);
@@ -902,29 +1350,6 @@ int board_list_moves(board_p B, coord_p src, coord_p dst, size_t n)
     return -1;
 }
 
-static int board_can_move_nc(board_p B, coord_p src, coord_p king)
-{
-    struct coord_t DST[GAME_MAX_MOVES_FOR_ONE_PIECE];
-    struct coord_t whence;
-    piece_t        king_under_check;
-    int            ncord;
-    int            n_actual_cord;
-    int            cur;
-
-    ncord         = board_list_moves(B, src, DST, sizeof(DST));
-    n_actual_cord = ncord;
-
-    for (cur = 0; cur < ncord; ++cur)
-    {
-        king_under_check = board_under_check_part_w(B, src, DST + cur, &whence);
-
-        if (king_under_check == board_get_at(B, king))
-            --n_actual_cord;
-    }
-
-    return n_actual_cord > 0;
-}
-
 piece_t
 board_under_check_part_w(board_p B, coord_p src, coord_p dst, coord_p whence)
 {
@@ -935,7 +1360,7 @@ board_under_check_part_w(board_p B, coord_p src, coord_p dst, coord_p whence)
 
     board_simulation_do(B, &simulation_data, src, dst);
 
-    whence->row = -1;
+    whence->row = whence->col = -1;
 
     board_under_check_part(B, &B->wking, whence);
 
@@ -997,22 +1422,133 @@ board_simulation_undo(board_p B, simul_restore_p R, coord_p src, coord_p dst)
 
 int board_under_check_mate_part(board_p B, coord_p king)
 {
-    int            res;
-    struct coord_t src;
-
-    res = 0;
+    struct board_gen_t G;
+    move16_t           m;
 
     /* If the king is not on the board (custom game / learning / or debug) */
     if (board_coord_out_of_bound(king))
         return 0;
 
-    for (src.row = 0; !res && src.row < 8; ++src.row)
-        for (src.col = 0; !res && src.col < 8; ++src.col)
-            if (board_get_at(B, &src) != cpEEMPTY &&
-                (board_get_at(B, &src) ^ board_get_at(B, king)) >= 0)
-                res = board_can_move_nc(B, &src, king);
+    /* One legal move is enough */
+    board_gen_init(&G, B, board_get_at(B, king) < 0 ? cpBTURN : cpWTURN);
+
+    return !board_gen_next(&G, BOARD_GEN_KING, &m);
+}
+
+size_t board_legal_moves(board_p B, turn_t turn, move16_t* M, size_t n)
+{
+    struct coord_t DST[GAME_MAX_MOVES_FOR_ONE_PIECE];
+    struct coord_t whence;
+    struct move_t  cur;
+    size_t         count;
+    move16_t       flags;
+    piece_t        src;
+    piece_t        morph;
+    piece_t        morph_last;
+    int            sq[64];
+    int            nsq;
+    int            ndst;
+    int            i;
+    int            j;
+
+    count = 0;
+    nsq   = board_pieces(B, turn > 0 ? BOARD_WHITE : BOARD_BLACK, sq);
+
+    for (j = 0; j < nsq; ++j)
+    {
+        cur.source.row = (myint8_t)(sq[j] / 8);
+        cur.source.col = (myint8_t)(sq[j] % 8);
+        src            = board_at(B, sq[j]);
+
+        ndst = board_list_moves(
+            B, &cur.source, DST, GAME_MAX_MOVES_FOR_ONE_PIECE
+        );
+
+        for (i = 0; i < ndst; ++i)
+        {
+            cur.dest = DST[i];
+            move_set_offset(&cur);
+
+            flags = board_get_at(B, &cur.dest) != cpEEMPTY ? MOVE16_CAPTURE
+                                                           : MOVE16_NONE;
+
+            /* A pawn reaching the other side morphs into a rook, a knight,
+             * a bishop or a queen; any other piece does not */
+            if (src == cpWPAWN && cur.dest.row == 0)
+            {
+                morph      = cpWROOK;
+                morph_last = cpWQUEEN;
+            }
+            else if (src == cpBPAWN && cur.dest.row == 7)
+            {
+                morph      = cpBQUEEN;
+                morph_last = cpBROOK;
+            }
+            else
+            {
+                morph      = cpEEMPTY;
+                morph_last = cpEEMPTY;
+            }
+
+            for (; morph <= morph_last && count < n; ++morph)
+            {
+                if (board_check_move(B, &cur, morph, turn, &whence) != NULL)
+                    continue;
+
+                M[count++] = (move16_t)(move16_pack(&cur, morph) | flags);
+            }
+        }
+    }
+
+    return count;
+}
+
+void board_gen_init(board_gen_p G, board_p B, turn_t turn)
+{
+    G->B     = B;
+    G->turn  = turn;
+    G->stage = BOARD_GEN_CAPTURES;
+    G->count = board_pieces(B, turn > 0 ? BOARD_WHITE : BOARD_BLACK, G->sq);
+    G->next  = 0;
+
+    /* Nothing left of a piece: the first one is taken at the first move */
+    G->targets    = 0;
+    G->morph      = cpWPAWN;
+    G->morph_last = cpEEMPTY;
+}
+
+int board_gen_next(board_gen_p G, int last_stage, move16_t* m)
+{
+    if (G->turn > 0)
+        return board_gen_next_WHITE(G, last_stage, m);
+
+    return board_gen_next_BLACK(G, last_stage, m);
+}
+
+unsigned long board_perft(board_p B, turn_t turn, unsigned int depth)
+{
+    move16_t       M[BOARD_MAX_MOVES];
+    struct board_t next;
+    unsigned long  nodes;
+    size_t         n;
+    size_t         cur;
+
+    if (depth == 0)
+        return 1;
+
+    n = board_legal_moves(B, turn, M, BOARD_MAX_MOVES);
+    if (depth == 1)
+        return n;
+
+    nodes = 0;
+    for (cur = 0; cur < n; ++cur)
+    {
+        next = *B;
+        board_exec16(&next, M[cur]);
+        nodes += board_perft(&next, (turn_t)~turn, depth - 1);
+    }
 
-    return !res;
+    return nodes;
 }
 
 int board_assert(board_p B, game_assert_p A)
@@ -1024,7 +1560,7 @@ int board_assert(board_p B, game_assert_p A)
     switch (A->kind)
     {
     case ASSERT_KIND_CHECK:
-        whence.row = -1;
+        whence.row = whence.col = -1;
         board_under_check_part(B, &A->src, &whence);
         if (whence.row != -1)
         {
@@ -1082,9 +1618,15 @@ void board_meminfo(void)
     printf(" board:         %lu\n", sizeof(T.board));
     printf(" wking:         %lu\n", sizeof(T.wking));
     printf(" bking:         %lu\n", sizeof(T.bking));
+    printf(" list:          %lu\n", sizeof(T.list));
+    printf(" count:         %lu\n", sizeof(T.count));
+    printf(" index:         %lu\n", sizeof(T.index));
+    printf(" occupied:      %lu\n", sizeof(T.occupied));
     printf(
         " -------------- %lu\n",
-        sizeof(T.board) + sizeof(T.wking) + sizeof(T.bking)
+        sizeof(T.board) + sizeof(T.wking) + sizeof(T.bking) +
+            sizeof(T.list) + sizeof(T.count) + sizeof(T.index) +
+            sizeof(T.occupied)
     );
 }
 #endif
@@ -15,12 +15,75 @@
 
 #define GAME_MAX_MOVES_FOR_ONE_PIECE 28
 
+/* More than the legal moves of any position (218 at most) */
+#define BOARD_MAX_MOVES 256
+
+/* Longest FEN written by board_to_fen, NUL terminator included */
+#define BOARD_FEN_LENGTH 92
+
+/* Colours of the piece lists of struct board_t */
+#define BOARD_WHITE 0
+#define BOARD_BLACK 1
+
+/* Bytes of struct board_packed_t */
+#define BOARD_PACKED_SIZE 32
+
+/* Stages of struct board_gen_t, in the order they are gone through */
+#define BOARD_GEN_CAPTURES 0 /* Captures and pawns morphing */
+#define BOARD_GEN_QUIETS 1   /* Any other move but the ones of the king */
+#define BOARD_GEN_KING 2     /* Last stage: any move is up to it */
+
+/* Layout of struct board_t.board (the board backend), picked at build time
+ * (see CMakeLists.txt):
+ * - mailbox (default): 64 cells, square sq on cell sq;
+ * - 0x88 (-DBOARD_0X88): 16 cells per row, the last 8 of which are padding
+ *   that is always empty, so that a step off the board (by a row, a column
+ *   or both) lands on a cell with bit 3 or bit 7 set, whatever the
+ *   direction: one test of the cell against 0x88 (see BOARD_OFF). It makes
+ *   struct board_t 64 bytes larger, and `cmc-chess bench` measures it no
+ *   faster than the mailbox: it is kept to compare the two.
+ *
+ * Anything else numbers squares as 8 * row + col (see attack.h): the piece
+ * lists, the bitboards, the moves. board_at and board_put take squares.
+ */
+#ifdef BOARD_0X88
+#define BOARD_CELLS 128
+#else
+#define BOARD_CELLS 64
+#endif
+
+/* Whether row, col is off the board, for row and col in -8 .. 15 (a square
+ * of the board and a step of a piece away from it, or -1): the cell of 0x88
+ * tested against 0x88, a test of the coordinates against 0 .. 7 otherwise */
+#ifdef BOARD_0X88
+#define BOARD_OFF(row, col) (((16 * (row) + (col)) & 0x88) != 0)
+#else
+#define BOARD_OFF(row, col) ((((row) | (col)) & ~7) != 0)
+#endif
+
 typedef struct board_t
 {
-    piece_t board[64];
+    piece_t board[BOARD_CELLS]; /* See BOARD_CELLS */
 
     struct coord_t wking;
     struct coord_t bking;
+
+    /* Squares of the pieces of each colour, in no particular order: the
+     * white ones are list[0 .. count[BOARD_WHITE] - 1], the black ones are
+     * list[64 - count[BOARD_BLACK] .. 63] (there are at most 64 pieces).
+     * index[sq] is the position of the piece on sq among the ones of its
+     * colour (counted from the end of list for black), for O(1) removal.
+     *
+     * board_set_at and board_exec keep them (and occupied) up to date;
+     * anything else writing board (board_put, board_clear) must call
+     * board_index afterwards.
+     */
+    myuint8_t list[64];
+    myuint8_t count[2];
+    myuint8_t index[64];
+
+    /* The same squares as bitboards (see attack.h), by colour */
+    myuint64_t occupied[2];
 }* board_p;
 
 extern const char* ILLEGAL_MOVE_FROM_OUT_OF_BOUND;
@@ -41,10 +104,103 @@ extern const char* ILLEGAL_MOVE_BISHOP_DESC;
 extern const char* ILLEGAL_MOVE_QUEEN_DESC;
 extern const char* ILLEGAL_MOVE_KING_DESC;
 
+extern const char* BOARD_FEN_ERR_PLACEMENT;
+extern const char* BOARD_FEN_ERR_KING;
+extern const char* BOARD_FEN_ERR_TURN;
+extern const char* BOARD_FEN_ERR_CASTLING;
+extern const char* BOARD_FEN_ERR_EN_PASSANT;
+extern const char* BOARD_FEN_ERR_CLOCK;
+extern const char* BOARD_FEN_ERR_TRAILING;
+
+extern const char* BOARD_PACKED_ERR_PIECE;
+extern const char* BOARD_PACKED_ERR_KING;
+
 extern piece_t board_get_at(board_p B, coord_p C);
 extern void    board_set_at(board_p B, coord_p C, piece_t p);
 extern void    board_init(board_p B);
-extern void    board_print(board_p B);
+
+/* The piece on square sq (8 * row + col), whatever the board backend */
+extern piece_t board_at(board_p B, int sq);
+
+/* Put p on square sq, leaving the piece lists alone: see struct board_t */
+extern void board_put(board_p B, int sq, piece_t p);
+
+/* Empty every square, leaving the piece lists alone */
+extern void board_clear(board_p B);
+
+/* Squares of B as bitboards (see attack.h), from a scan of B->board: they
+ * do not need the piece lists to be up to date. Where the build has vector
+ * instructions, a scan is a handful of compares (see CMakeLists.txt).
+ *
+ * board_mask: the squares holding p (the empty ones if p is cpEEMPTY);
+ * board_colour_mask: the ones holding a piece of colour (BOARD_WHITE or
+ * BOARD_BLACK).
+ */
+extern myuint64_t board_mask(board_p B, piece_t p);
+extern myuint64_t board_colour_mask(board_p B, int colour);
+
+/* Rebuild the piece lists of B from B->board */
+extern void board_index(board_p B);
+
+/* RETURN
+ * The name of the board backend of the build ("mailbox" or "0x88").
+ */
+extern const char* board_backend(void);
+
+/* The squares of a board, two per byte, whatever the board backend: square
+ * 2 * i in the high nibble of sq[i], square 2 * i + 1 in the low one. A
+ * nibble is 0 for an empty square, the piece kind (cpWPAWN ... cpWKING) for
+ * a white piece and 8 | kind for a black one.
+ *
+ * Kings and piece lists are found again while unpacking: two boards holding
+ * the same pieces pack to the same bytes, that can be compared and hashed as
+ * they are (dumps, see board_dump.h, and archive deduplication).
+ */
+typedef struct board_packed_t
+{
+    myuint8_t sq[BOARD_PACKED_SIZE];
+}* board_packed_p;
+
+/* Pack the squares of B into P */
+extern void board_pack(board_p B, board_packed_p P);
+
+/* Unpack P into B, kings and piece lists included.
+ *
+ * B is left untouched if P is not valid.
+ *
+ * RETURN
+ * NULL on success, BOARD_PACKED_ERR_* otherwise.
+ */
+extern const char* board_unpack(board_p B, const struct board_packed_t* P);
+
+extern void    board_print(board_p B, FILE* fp);
+
+/* Set B and turn from a FEN string, in a single pass and without allocating.
+ *
+ * Piece placement and side to move are mandatory. Castling availability, en
+ * passant target square and clocks are optional and are validated, but they
+ * are not kept: the board does not model them.
+ *
+ * If end is NULL, anything but blanks after the last field is an error;
+ * otherwise *end is set to the first char that has not been parsed (EPD
+ * operations, PGN tag quotes, ...).
+ *
+ * B and turn are left untouched on failure.
+ *
+ * RETURN
+ * NULL on success, BOARD_FEN_ERR_* otherwise.
+ */
+extern const char*
+board_from_fen(board_p B, turn_t* turn, const char* fen, const char** end);
+
+/* Write B and turn as a FEN string into buf, that should be able to hold
+ * BOARD_FEN_LENGTH chars. Castling and en passant are always "-" and clocks
+ * are always "0 1".
+ *
+ * RETURN
+ * The length of the string, 0 if buf is too small (buf is then not valid).
+ */
+extern size_t board_to_fen(board_p B, turn_t turn, char* buf, size_t n);
 
 /* If a check should occur, whence tells what piece would take over the king */
 const char* board_check_move(
@@ -56,6 +212,13 @@ const char* board_check_move(
  */
 extern void board_exec(board_p B, move_p M, piece_t pawn_morph);
 
+/* board_exec of a packed move, the piece a pawn morphs into being of the
+ * colour of the pawn.
+ *
+ * Unsafe
+ */
+extern void board_exec16(board_p B, move16_t m);
+
 /* Check if the parameter king is under check and sets whence.
  *
  * WARNING
@@ -78,14 +241,70 @@ board_under_check_part_w(board_p B, coord_p src, coord_p dst, coord_p whence);
 
 extern int board_under_check_mate_part(board_p B, coord_p king);
 
-/* Not using game_io: direct serialization */
-extern int board_dump(board_p B, FILE* fp);
+extern int board_list_moves(board_p B, coord_p src, coord_p dst, size_t n);
 
-/* Not using game_io: direct serialization */
-extern int board_restore(board_p B, FILE* fp);
+/* List the legal moves of turn into M, up to n moves.
+ *
+ * A move is legal if board_check_move accepts it; a pawn reaching the other
+ * side of the board yields a move for each piece it can morph into. Moves
+ * that take over a piece are flagged MOVE16_CAPTURE.
+ *
+ * RETURN
+ * The number of moves listed.
+ */
+extern size_t
+board_legal_moves(board_p B, turn_t turn, move16_t* M, size_t n);
 
-extern int board_list_moves(board_p B, coord_p src, coord_p dst, size_t n);
+/* Legal moves of a position, generated on demand one stage at a time: a
+ * move costs its legality check only when it is asked for.
+ *
+ * B must not change while the generator is in use, but for the changes
+ * board_check_move undoes.
+ */
+typedef struct board_gen_t
+{
+    board_p B;
+    turn_t  turn;
+    int     stage; /* BOARD_GEN_*, the one of the last move */
+
+    /* Pieces of turn, in board order, and the next one of the stage */
+    int sq[64];
+    int count;
+    int next;
+
+    /* Destinations of the stage left to the piece on src */
+    int        src;
+    myuint64_t targets;
+
+    /* Pieces left to morph into on dst (none if morph > morph_last) */
+    int     dst;
+    piece_t morph;
+    piece_t morph_last;
+}* board_gen_p;
+
+extern void board_gen_init(board_gen_p G, board_p B, turn_t turn);
 
+/* Set *m to the next legal move of a stage up to last_stage: the generator
+ * stops at the first move of a later stage, and goes on from there when
+ * asked with a later last_stage.
+ *
+ * Moves of a stage come by source square, then by destination square (and
+ * by piece pawns morph into, as board_legal_moves lists them).
+ *
+ * RETURN
+ * 1 if *m is set, 0 if there is no move left up to last_stage.
+ */
+extern int board_gen_next(board_gen_p G, int last_stage, move16_t* m);
+
+/* Count the leaf nodes of the tree of legal moves of the given depth, turn
+ * being the side to move at the root (perft). Moves are the ones of
+ * board_legal_moves.
+ */
+extern unsigned long board_perft(board_p B, turn_t turn, unsigned int depth);
+
+/* RETURN
+ * Whether C is off the board (see BOARD_OFF).
+ */
 extern int board_coord_out_of_bound(coord_p);
 
 extern int board_assert(board_p B, game_assert_p A);
@@ -0,0 +1,232 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "board_archive.h"
+#include "board_dump.h"
+
+const char* BOARD_ARCHIVE_ERR_OPEN   = "could not open archive";
+const char* BOARD_ARCHIVE_ERR_MAP    = "could not map archive in memory";
+const char* BOARD_ARCHIVE_ERR_SIZE   = "archive is truncated";
+const char* BOARD_ARCHIVE_ERR_INDEX  = "no such position in archive";
+const char* BOARD_ARCHIVE_ERR_CREATE = "could not create dump";
+const char* BOARD_ARCHIVE_ERR_MEMORY = "out of memory";
+
+/* Bytes of a record telling positions apart: the packed squares and the side
+ * to move (see board_dump.h) */
+#define BOARD_ARCHIVE_KEY_SIZE (BOARD_PACKED_SIZE + 1)
+
+/* Slots of the table of board_archive_dedup per record, at least: half of
+ * them at most are taken, probes stay short */
+#define BOARD_ARCHIVE_DEDUP_SLOTS 2
+
+static myuint64_t board_archive_hash(const myuint8_t* rec);
+
+const char* board_archive_open(board_archive_p A, const char* fname)
+{
+    struct stat st;
+    const char* err;
+    void*       base;
+    int         fd;
+
+    A->base  = NULL;
+    A->size  = 0;
+    A->count = 0;
+
+    fd       = open(fname, O_RDONLY);
+    if (fd == -1)
+        return BOARD_ARCHIVE_ERR_OPEN;
+
+    if (fstat(fd, &st) == -1)
+    {
+        close(fd);
+        return BOARD_ARCHIVE_ERR_OPEN;
+    }
+
+    if (st.st_size < BOARD_DUMP_HEADER_SIZE)
+    {
+        close(fd);
+        return BOARD_ARCHIVE_ERR_SIZE;
+    }
+
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    /* The mapping holds its own reference to the file */
+    close(fd);
+
+    if (base == MAP_FAILED)
+        return BOARD_ARCHIVE_ERR_MAP;
+
+    A->base = (const myuint8_t*)base;
+    A->size = (size_t)st.st_size;
+
+    err     = board_dump_check_header(A->base);
+    if (err == NULL &&
+        (A->size - BOARD_DUMP_HEADER_SIZE) % BOARD_DUMP_RECORD_SIZE != 0)
+        err = BOARD_ARCHIVE_ERR_SIZE;
+
+    if (err != NULL)
+    {
+        board_archive_close(A);
+        return err;
+    }
+
+    A->count = (A->size - BOARD_DUMP_HEADER_SIZE) / BOARD_DUMP_RECORD_SIZE;
+
+    return NULL;
+}
+
+void board_archive_close(board_archive_p A)
+{
+    if (A->base != NULL)
+        munmap((void*)A->base, A->size);
+
+    A->base  = NULL;
+    A->size  = 0;
+    A->count = 0;
+}
+
+const myuint8_t* board_archive_record(board_archive_p A, size_t i)
+{
+    if (i >= A->count)
+        return NULL;
+
+    return A->base + BOARD_DUMP_HEADER_SIZE + i * BOARD_DUMP_RECORD_SIZE;
+}
+
+const char*
+board_archive_get(board_archive_p A, size_t i, board_p B, turn_t* turn)
+{
+    const myuint8_t* rec;
+
+    rec = board_archive_record(A, i);
+    if (rec == NULL)
+        return BOARD_ARCHIVE_ERR_INDEX;
+
+    return board_dump_unpack(B, turn, rec);
+}
+
+const char* board_archive_foreach(
+    board_archive_p A, board_archive_visit_t visit, void* ctx
+)
+{
+    struct board_t   B;
+    turn_t           turn;
+    const char*      err;
+    const myuint8_t* rec;
+    size_t           i;
+
+    rec = A->base + BOARD_DUMP_HEADER_SIZE;
+    for (i = 0; i < A->count; ++i, rec += BOARD_DUMP_RECORD_SIZE)
+    {
+        err = board_dump_unpack(&B, &turn, rec);
+        if (err != NULL)
+            return err;
+
+        if (visit(ctx, i, &B, turn))
+            break;
+    }
+
+    return NULL;
+}
+
+const char*
+board_archive_dedup(board_archive_p A, const char* fname, size_t* kept)
+{
+    struct board_t   B;
+    turn_t           turn;
+    const char*      err;
+    const myuint8_t* records;
+    const myuint8_t* rec;
+    size_t*          slots; /* 1 + the index of a record written, 0 if free */
+    size_t           capacity;
+    size_t           mask;
+    size_t           i;
+    size_t           j;
+    FILE*            fp;
+
+    *kept = 0;
+
+    for (capacity = 1; capacity < BOARD_ARCHIVE_DEDUP_SLOTS * A->count;)
+        capacity *= 2;
+
+    slots = calloc(capacity, sizeof(size_t));
+    if (slots == NULL)
+        return BOARD_ARCHIVE_ERR_MEMORY;
+
+    fp = fopen(fname, "wb");
+    if (fp == NULL)
+    {
+        free(slots);
+        return BOARD_ARCHIVE_ERR_CREATE;
+    }
+
+    records = A->base + BOARD_DUMP_HEADER_SIZE;
+    mask    = capacity - 1;
+    err     = board_dump_header(fp);
+
+    for (i = 0; err == NULL && i < A->count; ++i)
+    {
+        rec = records + i * BOARD_DUMP_RECORD_SIZE;
+
+        /* Only valid positions are written */
+        err = board_dump_unpack(&B, &turn, rec);
+        if (err != NULL)
+            break;
+
+        for (j = board_archive_hash(rec) & mask; slots[j] != 0;
+             j = (j + 1) & mask)
+            if (memcmp(
+                    rec,
+                    records + (slots[j] - 1) * BOARD_DUMP_RECORD_SIZE,
+                    BOARD_ARCHIVE_KEY_SIZE
+                ) == 0)
+                break;
+
+        if (slots[j] != 0)
+            continue;
+
+        slots[j] = i + 1;
+        if (fwrite(rec, 1, BOARD_DUMP_RECORD_SIZE, fp) !=
+            BOARD_DUMP_RECORD_SIZE)
+            err = BOARD_DUMP_ERR_WRITE;
+        else
+            ++*kept;
+    }
+
+    if (fclose(fp) != 0 && err == NULL)
+        err = BOARD_DUMP_ERR_WRITE;
+
+    free(slots);
+
+    return err;
+}
+
+/* The key of rec, a packed board being four words, through the SplitMix64
+ * finalizer */
+static myuint64_t board_archive_hash(const myuint8_t* rec)
+{
+    myuint64_t h = rec[BOARD_PACKED_SIZE];
+    myuint64_t w;
+    int        i;
+
+    for (i = 0; i < BOARD_PACKED_SIZE; i += 8)
+    {
+        memcpy(&w, rec + i, sizeof(w));
+        h ^= w;
+        h = (h ^ (h >> 30)) * MYUINT64_C(0xBF58476D1CE4E5B9);
+        h = (h ^ (h >> 27)) * MYUINT64_C(0x94D049BB133111EB);
+        h ^= h >> 31;
+    }
+
+    return h;
+}
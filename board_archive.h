@@ -0,0 +1,76 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_BOARD_ARCHIVE_H
+#define CMC_CHESS_BOARD_ARCHIVE_H
+
+#include <stddef.h>
+
+#include "board.h"
+#include "int.h"
+#include "piece.h"
+
+/* Read-only view on a dump file holding many positions (see board_dump.h).
+ *
+ * The whole file is mapped in memory and its header is validated once, when
+ * the archive is opened. Records are then reached in O(1) without any copy;
+ * processes mapping the same archive share the page cache.
+ */
+typedef struct board_archive_t
+{
+    const myuint8_t* base;  /* Mapping, header included */
+    size_t           size;  /* Size of the mapping */
+    size_t           count; /* Number of records */
+}* board_archive_p;
+
+/* Called by board_archive_foreach for every position; iteration stops as soon
+ * as it returns non zero */
+typedef int (*board_archive_visit_t)(
+    void* ctx, size_t i, board_p B, turn_t turn
+);
+
+extern const char* BOARD_ARCHIVE_ERR_OPEN;
+extern const char* BOARD_ARCHIVE_ERR_MAP;
+extern const char* BOARD_ARCHIVE_ERR_SIZE;
+extern const char* BOARD_ARCHIVE_ERR_INDEX;
+extern const char* BOARD_ARCHIVE_ERR_CREATE;
+extern const char* BOARD_ARCHIVE_ERR_MEMORY;
+
+/* RETURN
+ * NULL on success, BOARD_ARCHIVE_ERR_* or BOARD_DUMP_ERR_* otherwise. A is
+ * left closed on failure.
+ */
+extern const char* board_archive_open(board_archive_p A, const char* fname);
+extern void        board_archive_close(board_archive_p A);
+
+/* Pointer to the i-th record, NULL if i is out of range */
+extern const myuint8_t* board_archive_record(board_archive_p A, size_t i);
+
+/* Unpack the i-th record into B and turn */
+extern const char*
+board_archive_get(board_archive_p A, size_t i, board_p B, turn_t* turn);
+
+/* Visit every position in order.
+ *
+ * RETURN
+ * NULL if all the records have been visited or visit stopped the iteration,
+ * the error of the first record that could not be unpacked otherwise.
+ */
+extern const char* board_archive_foreach(
+    board_archive_p A, board_archive_visit_t visit, void* ctx
+);
+
+/* Write the positions of A to the dump fname, each one once, in the order of
+ * their first record. Positions are told apart by their packed squares (see
+ * struct board_packed_t) and side to move, through a hash table of records.
+ *
+ * *kept is set to the number of positions written.
+ *
+ * RETURN
+ * NULL on success, BOARD_ARCHIVE_ERR_* or BOARD_DUMP_ERR_* otherwise (the
+ * first record that could not be unpacked).
+ */
+extern const char*
+board_archive_dedup(board_archive_p A, const char* fname, size_t* kept);
+
+#endif /* CMC_CHESS_BOARD_ARCHIVE_H */
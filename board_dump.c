@@ -0,0 +1,139 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#include "board_dump.h"
+#include "board.h"
+#include "int.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BOARD_DUMP_CHECKSUM_OFFSET 34
+
+static const char BOARD_DUMP_MAGIC[]  = "CMCB";
+
+const myuint8_t BOARD_DUMP_VERSION    = 1;
+
+const char* BOARD_DUMP_ERR_WRITE      = "could not write to file";
+const char* BOARD_DUMP_ERR_READ       = "could not read from file";
+const char* BOARD_DUMP_ERR_MAGIC      = "not a cmc-chess dump";
+const char* BOARD_DUMP_ERR_VERSION    = "unsupported dump version";
+const char* BOARD_DUMP_ERR_CHECKSUM   = "checksum mismatch, dump is corrupted";
+const char* BOARD_DUMP_ERR_RECORD     = "invalid position in dump";
+
+/* Fletcher-16 on n bytes of buf */
+static unsigned int board_dump_checksum(const myuint8_t* buf, size_t n);
+
+const char* board_dump_check_header(const myuint8_t* header)
+{
+    if (memcmp(header, BOARD_DUMP_MAGIC, 4) != 0)
+        return BOARD_DUMP_ERR_MAGIC;
+
+    if (header[4] != BOARD_DUMP_VERSION ||
+        header[5] != BOARD_DUMP_RECORD_SIZE)
+        return BOARD_DUMP_ERR_VERSION;
+
+    return NULL;
+}
+
+void board_dump_pack(board_p B, turn_t turn, myuint8_t* rec)
+{
+    struct board_packed_t P;
+    unsigned int          checksum;
+
+    board_pack(B, &P);
+    memcpy(rec, P.sq, BOARD_PACKED_SIZE);
+
+    rec[32]  = turn == cpWTURN ? 0 : 1;
+    rec[33]  = 0;
+
+    checksum = board_dump_checksum(rec, BOARD_DUMP_CHECKSUM_OFFSET);
+    rec[BOARD_DUMP_CHECKSUM_OFFSET]     = (myuint8_t)(checksum >> 8);
+    rec[BOARD_DUMP_CHECKSUM_OFFSET + 1] = (myuint8_t)(checksum & 0xFF);
+}
+
+const char* board_dump_unpack(board_p B, turn_t* turn, const myuint8_t* rec)
+{
+    struct board_packed_t P;
+    unsigned int          checksum;
+
+    checksum = (unsigned int)rec[BOARD_DUMP_CHECKSUM_OFFSET] << 8 |
+               rec[BOARD_DUMP_CHECKSUM_OFFSET + 1];
+    if (checksum != board_dump_checksum(rec, BOARD_DUMP_CHECKSUM_OFFSET))
+        return BOARD_DUMP_ERR_CHECKSUM;
+
+    if (rec[32] > 1)
+        return BOARD_DUMP_ERR_RECORD;
+
+    memcpy(P.sq, rec, BOARD_PACKED_SIZE);
+    if (board_unpack(B, &P) != NULL)
+        return BOARD_DUMP_ERR_RECORD;
+
+    *turn = rec[32] == 0 ? cpWTURN : cpBTURN;
+
+    return NULL;
+}
+
+const char* board_dump_header(FILE* fp)
+{
+    myuint8_t header[BOARD_DUMP_HEADER_SIZE];
+
+    memcpy(header, BOARD_DUMP_MAGIC, 4);
+    header[4] = BOARD_DUMP_VERSION;
+    header[5] = BOARD_DUMP_RECORD_SIZE;
+    header[6] = 0;
+    header[7] = 0;
+
+    if (fwrite(header, 1, sizeof(header), fp) != sizeof(header))
+        return BOARD_DUMP_ERR_WRITE;
+
+    return NULL;
+}
+
+const char* board_dump(board_p B, turn_t turn, FILE* fp)
+{
+    myuint8_t rec[BOARD_DUMP_RECORD_SIZE];
+
+    board_dump_pack(B, turn, rec);
+
+    if (fwrite(rec, 1, sizeof(rec), fp) != sizeof(rec))
+        return BOARD_DUMP_ERR_WRITE;
+
+    return NULL;
+}
+
+const char* board_restore_header(FILE* fp)
+{
+    myuint8_t header[BOARD_DUMP_HEADER_SIZE];
+
+    if (fread(header, 1, sizeof(header), fp) != sizeof(header))
+        return BOARD_DUMP_ERR_MAGIC;
+
+    return board_dump_check_header(header);
+}
+
+const char* board_restore(board_p B, turn_t* turn, FILE* fp)
+{
+    myuint8_t rec[BOARD_DUMP_RECORD_SIZE];
+
+    if (fread(rec, 1, sizeof(rec), fp) != sizeof(rec))
+        return BOARD_DUMP_ERR_READ;
+
+    return board_dump_unpack(B, turn, rec);
+}
+
+static unsigned int board_dump_checksum(const myuint8_t* buf, size_t n)
+{
+    unsigned int sum1 = 0;
+    unsigned int sum2 = 0;
+    size_t       cur;
+
+    for (cur = 0; cur < n; ++cur)
+    {
+        sum1 = (sum1 + buf[cur]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+
+    return sum2 << 8 | sum1;
+}
@@ -0,0 +1,80 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_BOARD_DUMP_H
+#define CMC_CHESS_BOARD_DUMP_H
+
+#include <stdio.h>
+
+#include "board.h"
+#include "int.h"
+#include "piece.h"
+
+/* Dump File Layout
+ *
+ * Not using game_io: direct serialization. Every multi-byte field is stored
+ * big-endian, so a dump does not depend on the compiler nor on the host.
+ *
+ * Header (BOARD_DUMP_HEADER_SIZE bytes):
+ * - 0..3:   magic "CMCB";
+ * - 4:      format version (BOARD_DUMP_VERSION);
+ * - 5:      size of one record (BOARD_DUMP_RECORD_SIZE);
+ * - 6..7:   reserved, zero.
+ *
+ * The header is followed by any number of records, back to back
+ * (BOARD_DUMP_RECORD_SIZE bytes each):
+ * - 0..31:  squares, as struct board_packed_t (see board.h): two per byte,
+ *           A8 in the high nibble of byte 0 and H1 in the low nibble of
+ *           byte 31. A nibble is 0 for an empty square, the piece kind
+ *           (cpWPAWN ... cpWKING) for a white piece and 8 | kind for a black
+ *           piece;
+ * - 32:     side to move (0 white, 1 black);
+ * - 33:     reserved, zero;
+ * - 34..35: Fletcher-16 checksum of bytes 0..33.
+ *
+ * King coordinates are not stored: they are found again while unpacking.
+ */
+#define BOARD_DUMP_HEADER_SIZE 8
+#define BOARD_DUMP_RECORD_SIZE 36
+
+extern const myuint8_t BOARD_DUMP_VERSION;
+
+extern const char* BOARD_DUMP_ERR_WRITE;
+extern const char* BOARD_DUMP_ERR_READ;
+extern const char* BOARD_DUMP_ERR_MAGIC;
+extern const char* BOARD_DUMP_ERR_VERSION;
+extern const char* BOARD_DUMP_ERR_CHECKSUM;
+extern const char* BOARD_DUMP_ERR_RECORD;
+
+/* Header must point to BOARD_DUMP_HEADER_SIZE bytes.
+ *
+ * RETURN
+ * NULL if the header is valid, BOARD_DUMP_ERR_* otherwise.
+ */
+extern const char* board_dump_check_header(const myuint8_t* header);
+
+/* Pack B and turn into rec, that must hold BOARD_DUMP_RECORD_SIZE bytes */
+extern void board_dump_pack(board_p B, turn_t turn, myuint8_t* rec);
+
+/* Unpack rec into B and turn.
+ *
+ * B and turn are left untouched if rec is not valid.
+ *
+ * RETURN
+ * NULL on success, BOARD_DUMP_ERR_* otherwise.
+ */
+extern const char*
+board_dump_unpack(board_p B, turn_t* turn, const myuint8_t* rec);
+
+/* Stream functions: the header must be written (read) once, at the beginning
+ * of the file, before any record.
+ *
+ * RETURN
+ * NULL on success, BOARD_DUMP_ERR_* otherwise.
+ */
+extern const char* board_dump_header(FILE* fp);
+extern const char* board_dump(board_p B, turn_t turn, FILE* fp);
+extern const char* board_restore_header(FILE* fp);
+extern const char* board_restore(board_p B, turn_t* turn, FILE* fp);
+
+#endif /* CMC_CHESS_BOARD_DUMP_H */
@@ -0,0 +1,78 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_BOOK_H
+#define CMC_CHESS_BOOK_H
+
+#include <stddef.h>
+
+#include "board.h"
+#include "int.h"
+#include "move.h"
+#include "piece.h"
+
+/* Polyglot opening books.
+ *
+ * A book is a sequence of 16 byte big-endian entries sorted by key:
+ *
+ *  0- 7: key of the position (see book_key);
+ *  8- 9: move (bits 0-5 to, 6-11 from, 12-14 promotion);
+ * 10-11: weight;
+ * 12-15: learn (ignored).
+ *
+ * The book is mapped in memory and never modified: a single book can be
+ * shared by any number of games and threads.
+ */
+
+#define BOOK_ENTRY_SIZE 16
+
+/* Number of 64 bit random values needed by book_key */
+#define BOOK_KEYS_COUNT 781
+
+typedef struct book_t
+{
+    const myuint8_t* base;
+    size_t           size;
+    size_t           count; /* Number of entries */
+}* book_p;
+
+typedef struct book_move_t
+{
+    struct move_t move;
+    piece_t       pawn_morph;
+    myuint16_t    weight;
+    int           castling; /* Encoded as the king taking its own rook */
+}* book_move_p;
+
+extern const char* BOOK_ERR_OPEN;
+extern const char* BOOK_ERR_MAP;
+extern const char* BOOK_ERR_SIZE;
+
+/* RETURN
+ * NULL on success, BOOK_ERR_* otherwise. On failure K is closed.
+ */
+extern const char* book_open(book_p K, const char* fname);
+extern void        book_close(book_p K);
+
+/* Polyglot key of B, turn being the side to move.
+ *
+ * The board does not keep castling rights: a king and a rook on their initial
+ * squares are taken as the right to castle on that side. En passant is not
+ * modelled and never contributes to the key.
+ */
+extern myuint64_t book_key(board_p B, turn_t turn);
+
+/* Binary search the entries of key.
+ *
+ * RETURN
+ * The number of entries of key; *first is set to the index of the first of
+ * them.
+ */
+extern size_t book_find(book_p K, myuint64_t key, size_t* first);
+
+/* Decode the entry i (that must be < K->count) for the position B, turn
+ * being the side to move */
+extern void
+book_entry(book_p K, size_t i, board_p B, turn_t turn, book_move_p E);
+
+#endif /* CMC_CHESS_BOOK_H */
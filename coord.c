@@ -13,6 +13,11 @@ void coord_init_by_str(coord_p C, const char* str)
 {
     C->col = (myint8_t)((str[0] & TO_UPPER_MASK) - 'A');
     C->row = (myint8_t)(8 - (str[1] - '0'));
+
+    /* Any other text is a square off the board: -1, as the board only tells
+     * apart coordinates a step away from it (see BOARD_OFF) */
+    if ((C->row | C->col) & ~7)
+        C->row = C->col = -1;
 }
 
 void coord_to_str(coord_p C, char* buf, size_t n)
@@ -8,6 +8,8 @@
 
 #include <stddef.h>
 
+/* A square off the board is kept within a step of a piece from it, -1 if it
+ * stands for no square at all (see BOARD_OFF in board.h) */
 typedef struct coord_t
 {
     myint8_t row;
@@ -0,0 +1,250 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#define _POSIX_C_SOURCE 200809L
+#include <ctype.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "epd.h"
+#include "exit_codes.h"
+#include "util.h"
+#include "workq.h"
+
+/* Lines waiting for a worker; enough to keep every worker busy without
+ * reading the whole file in advance */
+#define EPD_QUEUE_LENGTH 256
+
+typedef struct epd_item_t
+{
+    unsigned long lineno;
+    char          line[EPD_LINE_LENGTH];
+}* epd_item_p;
+
+/* State shared by the reader and the workers */
+typedef struct epd_run_t
+{
+    struct workq_t  queue;
+    unsigned int    max_depth;
+
+    pthread_mutex_t report_lock; /* Serializes output and totals */
+    unsigned long   positions;
+    unsigned long   failed;
+    unsigned long   nodes;
+}* epd_run_p;
+
+static void* epd_worker(void* arg);
+static void  epd_test(epd_run_p R, epd_item_p I);
+
+/* Find the next perft operation ("D<depth> <nodes>") in ops.
+ *
+ * RETURN
+ * A pointer past the operation, NULL if there is none left.
+ */
+static const char*
+epd_next_perft(const char* ops, unsigned int* depth, unsigned long* nodes);
+
+int epd_perft(const char* fname, unsigned int nthreads, unsigned int max_depth)
+{
+    struct epd_run_t  R;
+    struct epd_item_t I;
+    pthread_t*        workers;
+    FILE*             fp;
+    double            elapsed;
+    unsigned int      started;
+    unsigned int      cur;
+    int               ch;
+
+    fp = fopen(fname, "r");
+    if (fp == NULL)
+    {
+        perror(fname);
+        return CHESS_FILE_ERROR;
+    }
+
+    if (nthreads == 0)
+        nthreads = cpu_count();
+
+    workers = malloc(nthreads * sizeof(pthread_t));
+    if (workers == NULL || !workq_init(&R.queue, sizeof(I), EPD_QUEUE_LENGTH))
+    {
+        free(workers);
+        fclose(fp);
+        fprintf(stderr, "Error: out of memory.\n");
+        return CHESS_GAME_ERROR;
+    }
+
+    pthread_mutex_init(&R.report_lock, NULL);
+    R.max_depth = max_depth;
+    R.positions = 0;
+    R.failed    = 0;
+    R.nodes     = 0;
+
+    elapsed     = clock_ms();
+
+    for (started = 0; started < nthreads; ++started)
+        if (pthread_create(workers + started, NULL, epd_worker, &R) != 0)
+            break;
+
+    for (I.lineno = 1; fgets(I.line, sizeof(I.line), fp) != NULL; ++I.lineno)
+    {
+        if (strchr(I.line, '\n') == NULL && !feof(fp))
+        {
+            /* Drop the rest of the line: it would be read as a new one */
+            while ((ch = fgetc(fp)) != EOF && ch != '\n')
+                ;
+
+            pthread_mutex_lock(&R.report_lock);
+            printf("%lu: line too long\n", I.lineno);
+            ++R.failed;
+            pthread_mutex_unlock(&R.report_lock);
+            continue;
+        }
+
+        trim(I.line);
+        if (I.line[0] == '\0' || I.line[0] == '#')
+            continue;
+
+        /* Without workers nobody would pop: the line is tested right away */
+        if (started == 0)
+            epd_test(&R, &I);
+        else
+            workq_push(&R.queue, &I);
+    }
+
+    workq_close(&R.queue);
+    for (cur = 0; cur < started; ++cur)
+        pthread_join(workers[cur], NULL);
+
+    elapsed = clock_ms() - elapsed;
+
+    printf(
+        "%lu positions, %lu failed, %lu nodes in %.3f s (%.0f nodes/s)\n",
+        R.positions,
+        R.failed,
+        R.nodes,
+        elapsed / 1000.0,
+        elapsed > 0 ? (double)R.nodes * 1000.0 / elapsed : 0.0
+    );
+
+    pthread_mutex_destroy(&R.report_lock);
+    workq_destroy(&R.queue);
+    free(workers);
+    fclose(fp);
+
+    return R.failed == 0 ? CHESS_OK : CHESS_ASSERT_FAILED;
+}
+
+static void* epd_worker(void* arg)
+{
+    epd_run_p         R = arg;
+    struct epd_item_t I;
+
+    while (workq_pop(&R->queue, &I))
+        epd_test(R, &I);
+
+    return NULL;
+}
+
+static void epd_test(epd_run_p R, epd_item_p I)
+{
+    struct board_t B;
+    turn_t         turn;
+    const char*    err;
+    const char*    ops;
+    double         elapsed;
+    unsigned long  nodes;
+    unsigned long  want;
+    unsigned long  expected;
+    unsigned long  got;
+    unsigned int   want_depth;
+    unsigned int   depth;
+
+    err = board_from_fen(&B, &turn, I->line, &ops);
+    if (err != NULL)
+    {
+        pthread_mutex_lock(&R->report_lock);
+        printf("%lu: %s\n", I->lineno, err);
+        ++R->failed;
+        pthread_mutex_unlock(&R->report_lock);
+        return;
+    }
+
+    nodes    = 0;
+    expected = got = 0;
+    depth    = 0;
+    elapsed  = clock_ms();
+
+    /* Depths are checked in the order they appear; once a depth fails, the
+     * deeper ones are not worth the time */
+    while ((ops = epd_next_perft(ops, &want_depth, &want)) != NULL)
+    {
+        if (want_depth > R->max_depth)
+            continue;
+
+        depth    = want_depth;
+        expected = want;
+        got      = board_perft(&B, turn, depth);
+        nodes += got;
+
+        if (got != expected)
+            break;
+    }
+
+    elapsed = clock_ms() - elapsed;
+
+    pthread_mutex_lock(&R->report_lock);
+
+    ++R->positions;
+    R->nodes += nodes;
+
+    if (got != expected)
+    {
+        ++R->failed;
+        printf(
+            "%lu: FAIL D%u %lu, expected %lu (%.1f ms)\n",
+            I->lineno,
+            depth,
+            got,
+            expected,
+            elapsed
+        );
+    }
+    else
+    {
+        printf("%lu: ok %lu nodes (%.1f ms)\n", I->lineno, nodes, elapsed);
+    }
+
+    pthread_mutex_unlock(&R->report_lock);
+}
+
+static const char*
+epd_next_perft(const char* ops, unsigned int* depth, unsigned long* nodes)
+{
+    char* end;
+
+    while (ops != NULL)
+    {
+        ops = move_to_not_blank(ops);
+        if (*ops == ';')
+            ops = move_to_not_blank(ops + 1);
+
+        if (*ops == '\0')
+            return NULL;
+
+        if (*ops == 'D' && isdigit((unsigned char)ops[1]))
+        {
+            *depth = (unsigned int)strtoul(ops + 1, &end, 10);
+            *nodes = strtoul(end, &end, 10);
+            return end;
+        }
+
+        /* Not a perft operation: skip it */
+        ops = strchr(ops, ';');
+    }
+
+    return NULL;
+}
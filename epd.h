@@ -0,0 +1,31 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_EPD_H
+#define CMC_CHESS_EPD_H
+
+/* Longest EPD line, NUL terminator included */
+#define EPD_LINE_LENGTH 512
+
+/* Run the perft suite in the EPD file fname.
+ *
+ * Every line holds a position (the first four FEN fields) followed by
+ * operations; operations in the form "D<depth> <nodes>" are perft tests, the
+ * others are ignored. For example:
+ *
+ *     4k3/8/8/8/8/8/8/4K2R w K - ;D1 15 ;D2 66 ;D3 1197
+ *
+ * Blank lines and lines starting with '#' are skipped.
+ *
+ * The file is streamed: lines are handed to nthreads workers (one per CPU if
+ * nthreads is 0) through a bounded queue. Depths greater than max_depth are
+ * skipped. The result of each position (with its timing) is printed as soon
+ * as it is available, the aggregate nodes per second at the end.
+ *
+ * RETURN
+ * An exit code (see exit_codes.h).
+ */
+extern int
+epd_perft(const char* fname, unsigned int nthreads, unsigned int max_depth);
+
+#endif /* CMC_CHESS_EPD_H */
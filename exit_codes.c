@@ -11,6 +11,10 @@ static const char* CHESS_COMMAND_NA_DEBUG_UNDEF_STR =
     "Command not available (!def DEBUG)";
 static const char* CHESS_COMMAND_UNKNOWN_STR  = "Command unknown";
 static const char* CHESS_GAME_IO_NOT_INIT_STR = "Game I/O not initialized";
+static const char* CHESS_COMMAND_BAD_ARGS_STR = "Bad command arguments";
+static const char* CHESS_ARCHIVE_ERROR_STR    = "Archive error";
+static const char* CHESS_FILE_ERROR_STR       = "Could not read input file";
+static const char* CHESS_SERVER_ERROR_STR     = "Server error";
 
 const char* chess_error_str(int n)
 {
@@ -30,6 +34,14 @@ const char* chess_error_str(int n)
         return CHESS_COMMAND_UNKNOWN_STR;
     case CHESS_GAME_IO_NOT_INIT:
         return CHESS_GAME_IO_NOT_INIT_STR;
+    case CHESS_COMMAND_BAD_ARGS:
+        return CHESS_COMMAND_BAD_ARGS_STR;
+    case CHESS_ARCHIVE_ERROR:
+        return CHESS_ARCHIVE_ERROR_STR;
+    case CHESS_FILE_ERROR:
+        return CHESS_FILE_ERROR_STR;
+    case CHESS_SERVER_ERROR:
+        return CHESS_SERVER_ERROR_STR;
 
     default:
         return "FAILED";
@@ -13,6 +13,10 @@ enum
     CHESS_COMMAND_NA_DEBUG_UNDEF = 4,
     CHESS_COMMAND_UNKNOWN        = 5, /* argv[1] */
     CHESS_GAME_IO_NOT_INIT       = 6, /* argv[1] */
+    CHESS_COMMAND_BAD_ARGS       = 7, /* argv[2...] */
+    CHESS_ARCHIVE_ERROR          = 8,
+    CHESS_FILE_ERROR             = 9,
+    CHESS_SERVER_ERROR           = 10,
 
     ___cmc_chess_exit_codes_h_enum_sentinel
 };
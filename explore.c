@@ -0,0 +1,545 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "attack.h"
+#include "exit_codes.h"
+#include "explore.h"
+#include "pgn.h"
+#include "util.h"
+
+const char* EXPLORE_ERR_OPEN    = "could not open index";
+const char* EXPLORE_ERR_MAP     = "could not map index in memory";
+const char* EXPLORE_ERR_MAGIC   = "not an index";
+const char* EXPLORE_ERR_VERSION = "unsupported index version";
+const char* EXPLORE_ERR_SIZE    = "index is truncated";
+
+static const char*     EXPLORE_MAGIC   = "CMCX";
+static const myuint8_t EXPLORE_VERSION = 1;
+
+/* Shards of the in-memory map: workers only contend on the same shard. The
+ * shard is chosen by the high bits of the hash, the slot by the low ones */
+#define EXPLORE_SHARDS 64
+#define EXPLORE_SHARD_SHIFT 58
+#define EXPLORE_SHARD_CAPACITY 1024
+
+/* Zobrist keys: 12 piece kinds by 64 squares, then the side to move */
+#define EXPLORE_KEYS_COUNT (12 * 64 + 1)
+
+typedef struct explore_slot_t
+{
+    myuint64_t key;
+    myuint32_t games[4];
+    move16_t   move;
+    myuint8_t  used;
+}* explore_slot_p;
+
+typedef struct explore_shard_t
+{
+    pthread_mutex_t lock;
+    explore_slot_p  slots;
+    size_t          capacity; /* Power of 2 */
+    size_t          count;
+}* explore_shard_p;
+
+/* State of explore_build, shared by its workers */
+typedef struct explore_build_t
+{
+    struct explore_shard_t shards[EXPLORE_SHARDS];
+
+    pthread_mutex_t stats_lock;
+    unsigned long   games;
+    unsigned long   truncated; /* Indexed up to their first illegal move */
+    unsigned long   skipped;   /* Illegal from the first move (or tag) */
+    int             oom;
+}* explore_build_p;
+
+/* Moves of one game, collected by explore_build_visit */
+typedef struct explore_game_t
+{
+    myuint64_t keys[EXPLORE_MAX_PLIES];
+    move16_t   moves[EXPLORE_MAX_PLIES];
+    size_t     plies;
+}* explore_game_p;
+
+static myuint64_t     explore_keys[EXPLORE_KEYS_COUNT];
+static pthread_once_t explore_keys_once = PTHREAD_ONCE_INIT;
+
+static void       explore_keys_init(void);
+static myuint64_t explore_mix(myuint64_t x);
+
+static void explore_build_game(void* ctx, pgn_game_p G);
+static int explore_build_visit(
+    void* ctx, board_p B, turn_t turn, move_p M, piece_t pawn_morph
+);
+static int explore_insert(
+    explore_shard_p S, myuint64_t hash, myuint64_t key, move16_t move,
+    int result
+);
+static explore_slot_p explore_grow(explore_shard_p S);
+static int            explore_slot_cmp(const void* a, const void* b);
+static int
+explore_write(explore_build_p X, const char* fname, size_t* count);
+static void          explore_put(myuint8_t* p, unsigned long v, int bytes);
+static unsigned long explore_get(const myuint8_t* p, int bytes);
+
+myuint64_t explore_key(board_p B, turn_t turn)
+{
+    myuint64_t key = 0;
+    myuint64_t occupied;
+    piece_t    p;
+    int        sq;
+
+    pthread_once(&explore_keys_once, explore_keys_init);
+
+    for (occupied = ~board_mask(B, cpEEMPTY); occupied != 0;
+         occupied &= occupied - 1)
+    {
+        sq = attack_first(occupied);
+        p  = board_at(B, sq);
+
+        /* White pieces 0..5, black pieces 6..11 */
+        key ^= explore_keys[64 * (p > 0 ? p - 1 : 5 - p) + sq];
+    }
+
+    if (turn == cpWTURN)
+        key ^= explore_keys[EXPLORE_KEYS_COUNT - 1];
+
+    return key;
+}
+
+int explore_build(const char* fname, const char* pgn, unsigned int nthreads)
+{
+    struct explore_build_t X;
+    double                 elapsed;
+    size_t                 count;
+    size_t                 i;
+    int                    ret;
+
+    X.games     = 0;
+    X.truncated = 0;
+    X.skipped   = 0;
+    X.oom       = 0;
+    pthread_mutex_init(&X.stats_lock, NULL);
+
+    for (i = 0; i < EXPLORE_SHARDS; ++i)
+    {
+        pthread_mutex_init(&X.shards[i].lock, NULL);
+        X.shards[i].capacity = EXPLORE_SHARD_CAPACITY;
+        X.shards[i].count    = 0;
+        X.shards[i].slots =
+            calloc(EXPLORE_SHARD_CAPACITY, sizeof(struct explore_slot_t));
+        X.oom = X.oom || X.shards[i].slots == NULL;
+    }
+
+    elapsed = clock_ms();
+
+    ret     = X.oom ? CHESS_GAME_ERROR
+                    : pgn_foreach(pgn, nthreads, explore_build_game, &X);
+
+    if (ret == CHESS_OK && X.oom)
+        ret = CHESS_GAME_ERROR;
+
+    count = 0;
+    if (ret == CHESS_OK)
+        ret = explore_write(&X, fname, &count);
+
+    elapsed = clock_ms() - elapsed;
+
+    if (ret == CHESS_OK)
+        printf(
+            "%lu games, %lu truncated, %lu skipped, %lu entries in %.3f s\n",
+            X.games,
+            X.truncated,
+            X.skipped,
+            (unsigned long)count,
+            elapsed / 1000.0
+        );
+    else if (X.oom)
+        fprintf(stderr, "Error: out of memory.\n");
+
+    for (i = 0; i < EXPLORE_SHARDS; ++i)
+    {
+        free(X.shards[i].slots);
+        pthread_mutex_destroy(&X.shards[i].lock);
+    }
+    pthread_mutex_destroy(&X.stats_lock);
+
+    return ret;
+}
+
+const char* explore_open(explore_p X, const char* fname)
+{
+    struct stat st;
+    void*       base;
+    int         fd;
+
+    X->base  = NULL;
+    X->size  = 0;
+    X->count = 0;
+
+    fd       = open(fname, O_RDONLY);
+    if (fd == -1)
+        return EXPLORE_ERR_OPEN;
+
+    if (fstat(fd, &st) == -1)
+    {
+        close(fd);
+        return EXPLORE_ERR_OPEN;
+    }
+
+    if (st.st_size < EXPLORE_HEADER_SIZE ||
+        (st.st_size - EXPLORE_HEADER_SIZE) % EXPLORE_ENTRY_SIZE != 0)
+    {
+        close(fd);
+        return EXPLORE_ERR_SIZE;
+    }
+
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    /* The mapping holds its own reference to the file */
+    close(fd);
+
+    if (base == MAP_FAILED)
+        return EXPLORE_ERR_MAP;
+
+    X->base = (const myuint8_t*)base;
+    X->size = (size_t)st.st_size;
+
+    if (memcmp(X->base, EXPLORE_MAGIC, 4) != 0)
+    {
+        explore_close(X);
+        return EXPLORE_ERR_MAGIC;
+    }
+
+    if (X->base[4] != EXPLORE_VERSION || X->base[5] != EXPLORE_ENTRY_SIZE)
+    {
+        explore_close(X);
+        return EXPLORE_ERR_VERSION;
+    }
+
+    posix_madvise(base, (size_t)st.st_size, POSIX_MADV_RANDOM);
+
+    X->count = (X->size - EXPLORE_HEADER_SIZE) / EXPLORE_ENTRY_SIZE;
+
+    return NULL;
+}
+
+void explore_close(explore_p X)
+{
+    if (X->base != NULL)
+        munmap((void*)X->base, X->size);
+
+    X->base  = NULL;
+    X->size  = 0;
+    X->count = 0;
+}
+
+size_t explore_find(explore_p X, myuint64_t key, size_t* first)
+{
+    const myuint8_t* entries = X->base + EXPLORE_HEADER_SIZE;
+    size_t           lo      = 0;
+    size_t           hi      = X->count;
+    size_t           mid;
+    size_t           last;
+
+    /* Lower bound */
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (explore_get(entries + mid * EXPLORE_ENTRY_SIZE, 8) < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    for (last = lo; last < X->count &&
+                    explore_get(entries + last * EXPLORE_ENTRY_SIZE, 8) == key;
+         ++last)
+        ;
+
+    *first = lo;
+
+    return last - lo;
+}
+
+void explore_entry(explore_p X, size_t i, turn_t turn, explore_entry_p E)
+{
+    const myuint8_t* p;
+    unsigned long    move;
+    int              r;
+
+    p    = X->base + EXPLORE_HEADER_SIZE + i * EXPLORE_ENTRY_SIZE;
+    move = explore_get(p + 8, 2);
+
+    move16_unpack((move16_t)move, turn, &E->move, &E->pawn_morph);
+
+    for (r = 0; r < 4; ++r)
+        E->games[r] = (myuint32_t)explore_get(p + 12 + 4 * r, 4);
+}
+
+static void explore_keys_init(void)
+{
+    myuint64_t seed = 0;
+    size_t     i;
+
+    for (i = 0; i < EXPLORE_KEYS_COUNT; ++i)
+        explore_keys[i] = explore_mix(seed += MYUINT64_C(0x9E3779B97F4A7C15));
+}
+
+/* SplitMix64 finalizer */
+static myuint64_t explore_mix(myuint64_t x)
+{
+    x = (x ^ (x >> 30)) * MYUINT64_C(0xBF58476D1CE4E5B9);
+    x = (x ^ (x >> 27)) * MYUINT64_C(0x94D049BB133111EB);
+
+    return x ^ (x >> 31);
+}
+
+static void explore_build_game(void* ctx, pgn_game_p G)
+{
+    explore_build_p       X = ctx;
+    struct explore_game_t M;
+    struct pgn_replay_t   R;
+    explore_shard_p       S;
+    myuint64_t            hash;
+    size_t                i;
+    int                   truncated;
+    int                   oom;
+
+    M.plies = 0;
+
+    /* The moves before the first illegal one (castling, for the board) are
+     * still indexed */
+    truncated = pgn_replay(G, explore_build_visit, &M, &R) != NULL;
+    if (truncated && M.plies == 0)
+    {
+        pthread_mutex_lock(&X->stats_lock);
+        ++X->games;
+        ++X->skipped;
+        pthread_mutex_unlock(&X->stats_lock);
+        return;
+    }
+
+    for (oom = 0, i = 0; i < M.plies && !oom; ++i)
+    {
+        hash = explore_mix(M.keys[i] ^ M.moves[i]);
+        S    = &X->shards[hash >> EXPLORE_SHARD_SHIFT & (EXPLORE_SHARDS - 1)];
+
+        pthread_mutex_lock(&S->lock);
+        oom = !explore_insert(S, hash, M.keys[i], M.moves[i], R.result);
+        pthread_mutex_unlock(&S->lock);
+    }
+
+    pthread_mutex_lock(&X->stats_lock);
+    ++X->games;
+    X->truncated += (unsigned long)truncated;
+    X->oom = X->oom || oom;
+    pthread_mutex_unlock(&X->stats_lock);
+}
+
+static int explore_build_visit(
+    void* ctx, board_p B, turn_t turn, move_p M, piece_t pawn_morph
+)
+{
+    explore_game_p G = ctx;
+
+    /* The rest of the game is not indexed: no need to replay it */
+    if (G->plies == EXPLORE_MAX_PLIES)
+        return 0;
+
+    G->keys[G->plies]  = explore_key(B, turn);
+    G->moves[G->plies] = move16_pack(M, pawn_morph);
+    ++G->plies;
+
+    return 1;
+}
+
+static int explore_insert(
+    explore_shard_p S, myuint64_t hash, myuint64_t key, move16_t move,
+    int result
+)
+{
+    explore_slot_p slot;
+    explore_slot_p slots;
+    size_t         i;
+
+    /* Keep the load factor under 3/4 */
+    if (4 * (S->count + 1) > 3 * S->capacity)
+    {
+        slots = explore_grow(S);
+        if (slots == NULL)
+            return 0;
+
+        free(S->slots);
+        S->slots = slots;
+        S->capacity *= 2;
+    }
+
+    for (i = hash & (S->capacity - 1);; i = (i + 1) & (S->capacity - 1))
+    {
+        slot = S->slots + i;
+
+        if (!slot->used)
+        {
+            slot->used = 1;
+            slot->key  = key;
+            slot->move = move;
+            ++S->count;
+            break;
+        }
+
+        if (slot->key == key && slot->move == move)
+            break;
+    }
+
+    ++slot->games[result];
+
+    return 1;
+}
+
+/* RETURN
+ * The slots of S rehashed into a table twice as large, NULL if memory could
+ * not be allocated.
+ */
+static explore_slot_p explore_grow(explore_shard_p S)
+{
+    explore_slot_p slots;
+    explore_slot_p slot;
+    size_t         capacity = 2 * S->capacity;
+    size_t         cur;
+    size_t         i;
+
+    slots = calloc(capacity, sizeof(struct explore_slot_t));
+    if (slots == NULL)
+        return NULL;
+
+    for (cur = 0; cur < S->capacity; ++cur)
+    {
+        if (!S->slots[cur].used)
+            continue;
+
+        slot = S->slots + cur;
+        for (i = explore_mix(slot->key ^ slot->move) & (capacity - 1);
+             slots[i].used;
+             i = (i + 1) & (capacity - 1))
+            ;
+
+        slots[i] = *slot;
+    }
+
+    return slots;
+}
+
+static int explore_slot_cmp(const void* a, const void* b)
+{
+    const struct explore_slot_t* A = a;
+    const struct explore_slot_t* B = b;
+
+    if (A->key != B->key)
+        return A->key < B->key ? -1 : 1;
+
+    return (int)A->move - (int)B->move;
+}
+
+static int explore_write(explore_build_p X, const char* fname, size_t* count)
+{
+    myuint8_t      buf[EXPLORE_ENTRY_SIZE];
+    explore_slot_p all;
+    FILE*          fp;
+    size_t         n;
+    size_t         cur;
+    size_t         i;
+    int            r;
+    int            ok;
+
+    for (n = 0, i = 0; i < EXPLORE_SHARDS; ++i)
+        n += X->shards[i].count;
+
+    /* Slots are compacted one shard at a time, so that each shard can be
+     * freed as soon as it has been copied */
+    all = malloc((n > 0 ? n : 1) * sizeof(struct explore_slot_t));
+    if (all == NULL)
+    {
+        X->oom = 1;
+        return CHESS_GAME_ERROR;
+    }
+
+    for (n = 0, i = 0; i < EXPLORE_SHARDS; ++i)
+    {
+        for (cur = 0; cur < X->shards[i].capacity; ++cur)
+            if (X->shards[i].slots[cur].used)
+                all[n++] = X->shards[i].slots[cur];
+
+        free(X->shards[i].slots);
+        X->shards[i].slots = NULL;
+    }
+
+    qsort(all, n, sizeof(struct explore_slot_t), explore_slot_cmp);
+
+    fp = fopen(fname, "wb");
+    if (fp == NULL)
+    {
+        perror(fname);
+        free(all);
+        return CHESS_FILE_ERROR;
+    }
+
+    memset(buf, 0, sizeof(buf));
+    memcpy(buf, EXPLORE_MAGIC, 4);
+    buf[4] = EXPLORE_VERSION;
+    buf[5] = EXPLORE_ENTRY_SIZE;
+    ok     = fwrite(buf, EXPLORE_HEADER_SIZE, 1, fp) == 1;
+
+    for (i = 0; i < n && ok; ++i)
+    {
+        explore_put(buf, all[i].key, 8);
+        explore_put(buf + 8, all[i].move, 2);
+        explore_put(buf + 10, 0, 2);
+        for (r = 0; r < 4; ++r)
+            explore_put(buf + 12 + 4 * r, all[i].games[r], 4);
+
+        ok = fwrite(buf, sizeof(buf), 1, fp) == 1;
+    }
+
+    free(all);
+
+    if (fclose(fp) != 0 || !ok)
+    {
+        perror(fname);
+        return CHESS_FILE_ERROR;
+    }
+
+    *count = n;
+
+    return CHESS_OK;
+}
+
+static void explore_put(myuint8_t* p, unsigned long v, int bytes)
+{
+    while (bytes-- > 0)
+    {
+        p[bytes] = (myuint8_t)(v & 0xFF);
+        v >>= 8;
+    }
+}
+
+static unsigned long explore_get(const myuint8_t* p, int bytes)
+{
+    unsigned long v = 0;
+    int           i;
+
+    for (i = 0; i < bytes; ++i)
+        v = v << 8 | p[i];
+
+    return v;
+}
@@ -0,0 +1,91 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_EXPLORE_H
+#define CMC_CHESS_EXPLORE_H
+
+#include <stddef.h>
+
+#include "board.h"
+#include "int.h"
+#include "move.h"
+#include "piece.h"
+
+/* Opening Explorer Index Layout
+ *
+ * Every multi-byte field is stored big-endian.
+ *
+ * Header (EXPLORE_HEADER_SIZE bytes):
+ * - 0..3:   magic "CMCX";
+ * - 4:      format version;
+ * - 5:      size of one entry (EXPLORE_ENTRY_SIZE);
+ * - 6..7:   reserved, zero.
+ *
+ * Entries, sorted by key and then by move (EXPLORE_ENTRY_SIZE bytes each):
+ * - 0..7:   key of the position (see explore_key);
+ * - 8..9:   move (move16_t, without flags: see move16_pack);
+ * - 10..11: reserved, zero;
+ * - 12..27: number of games by result, indexed by PGN_RESULT_* (4 bytes
+ *           each).
+ */
+#define EXPLORE_HEADER_SIZE 8
+#define EXPLORE_ENTRY_SIZE 28
+
+/* Moves of a game that are indexed: the explorer is about openings */
+#define EXPLORE_MAX_PLIES 40
+
+extern const char* EXPLORE_ERR_OPEN;
+extern const char* EXPLORE_ERR_MAP;
+extern const char* EXPLORE_ERR_MAGIC;
+extern const char* EXPLORE_ERR_VERSION;
+extern const char* EXPLORE_ERR_SIZE;
+
+typedef struct explore_t
+{
+    const myuint8_t* base;
+    size_t           size;
+    size_t           count; /* Number of entries */
+}* explore_p;
+
+typedef struct explore_entry_t
+{
+    struct move_t move;
+    piece_t       pawn_morph;
+    myuint32_t    games[4]; /* By PGN_RESULT_* */
+}* explore_entry_p;
+
+/* Zobrist key of B, turn being the side to move. Thread safe */
+extern myuint64_t explore_key(board_p B, turn_t turn);
+
+/* Build the index fname from the games in the PGN file pgn, using nthreads
+ * workers (one per CPU if nthreads is 0). Only the first EXPLORE_MAX_PLIES
+ * plies of a game are replayed; a game with an illegal move among them
+ * (castling, that the board does not play, included) is indexed up to that
+ * move.
+ *
+ * RETURN
+ * An exit code (see exit_codes.h).
+ */
+extern int
+explore_build(const char* fname, const char* pgn, unsigned int nthreads);
+
+/* RETURN
+ * NULL on success, EXPLORE_ERR_* otherwise. On failure X is closed.
+ */
+extern const char* explore_open(explore_p X, const char* fname);
+extern void        explore_close(explore_p X);
+
+/* Binary search the entries of key.
+ *
+ * RETURN
+ * The number of entries of key; *first is set to the index of the first of
+ * them.
+ */
+extern size_t explore_find(explore_p X, myuint64_t key, size_t* first);
+
+/* Decode the entry i (that must be < X->count), turn being the side to
+ * move */
+extern void
+explore_entry(explore_p X, size_t i, turn_t turn, explore_entry_p E);
+
+#endif /* CMC_CHESS_EXPLORE_H */
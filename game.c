@@ -4,19 +4,32 @@
 #define _POSIX_C_SOURCE 200809L
 #include <errno.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 
+#include "attack.h"
 #include "board.h"
+#include "board_archive.h"
+#include "board_dump.h"
+#include "book.h"
+#include "explore.h"
 #include "game.h"
 #include "game_assert.h"
 #include "game_history.h"
 #include "game_io.h"
+#include "kpk.h"
+#include "pgn.h"
+#include "tb.h"
 #include "util.h"
 
 static void game_refresh(game_p G);
 
+static int  game_cold_get(game_p G);
+static void game_cold_put(game_p G);
+static void game_prompt(game_p G);
 static void game_read_command(game_p G);
+static void game_command(game_p G);
 static void game_decode_command(game_p G);
 static void game_next_turn(game_p G);
 static void game_set_flag(game_p G, int flag);
@@ -26,30 +39,55 @@ static int  game_has_flag(game_p G, int flag);
 static void game_comm_play_move(game_p G);
 
 static void game_comm_dot_new(game_p G);
-static void game_comm_dot_dump(game_p G);
-static void game_comm_dot_restore(game_p G);
+static void game_reset(game_p G);
+static void game_comm_dot_dump(game_p G, int append);
+static void game_comm_dot_restore(game_p G, int at);
 static void game_comm_dot_noclear(game_p G);
 static void game_comm_dot_save(game_p G, int force);
 static void game_comm_dot_comment(game_p G);
 static void game_comm_dot_load(game_p G);
 static void game_comm_dot_norecord(game_p G);
 static void game_comm_dot_record(game_p G);
+static void game_comm_dot_book(game_p G);
+static void game_comm_dot_book_move(game_p G);
+static void game_comm_dot_explore(game_p G);
+static void game_comm_dot_tbgen(game_p G);
+static void game_comm_dot_tbmove(game_p G);
+static void game_comm_dot_tbsave(game_p G);
+static void game_comm_dot_tbload(game_p G);
+static void game_comm_dot_analyze(game_p G);
+static void game_comm_dot_stop(game_p G);
+static void game_comm_dot_ponder(game_p G);
 
 static void game_comm_eq_clear(game_p G);
 static void game_comm_eq_set(game_p G);
 static void game_comm_eq_assert(game_p G);
+static void game_comm_eq_fen(game_p G);
 
 static void game_comm_qm_list(game_p G);
+static void game_comm_qm_fen(game_p G);
+static void game_comm_qm_book(game_p G);
+static void game_comm_qm_explore(game_p G);
+static void game_comm_qm_dtm(game_p G);
+static void game_comm_qm_kpk(game_p G);
+
+static void  game_analysis_start(game_p G, int depth);
+static void  game_analysis_stop(game_p G);
+static void* game_analysis_run(void* arg);
+static void  game_analysis_report(void* ctx, search_p S);
+static void  game_analysis_move_str(search_p S, char* buf);
 
 const char* GAME_DONE_COULD_NOT_READ_STDIN = "could not read stdin";
 const char* GAME_DONE_COMM_QUIT            = "closed by user";
 const char* GAME_DONE_ASSERT_FAILED        = "assert failed";
 const char* GAME_DONE_ASSERT_PARSE         = "could not parse assert";
+const char* GAME_DONE_NO_MEMORY            = "out of memory";
 
 void game_init(game_p G, int flags)
 {
     memset(G, 0, sizeof(struct game_t));
-    game_msg_init(&G->message);
+    game_io_init(&G->io, stdin, stdout);
+    history_init(&G->history);
     G->turn      = cpWTURN;
     G->comm_type = GX_UNKNOWN;
     G->opts      = flags;
@@ -57,110 +95,294 @@ void game_init(game_p G, int flags)
     board_init(&G->board);
 }
 
+void game_pool_init(pool_p P) { pool_init(P, sizeof(struct game_cold_t)); }
+
 void game_run(game_p G)
 {
-    history_init();
-    game_io_init();
+    game_start(G);
 
     while (G->done == NULL)
     {
-        if (game_has_flag(G, GOPT_CLEAR))
-            clear();
+        game_read_command(G);
 
-        game_refresh(G);
+        if (G->done == NULL)
+            game_command(G);
+    }
+}
 
-        do
-        {
-            game_io_printf("Command: ");
+void game_start(game_p G)
+{
+    if (game_cold_get(G))
+        game_prompt(G);
+}
+
+void game_input(game_p G, const char* line)
+{
+    size_t len = strlen(line);
+
+    if (!game_cold_get(G))
+        return;
 
-            game_read_command(G);
-            game_decode_command(G);
+    if (len >= sizeof(G->cold->comm_buf))
+        len = sizeof(G->cold->comm_buf) - 1;
 
-            if (G->done != NULL)
-                return;
+    memcpy(G->cold->comm_buf, line, len);
+    G->cold->comm_buf[len] = '\0';
 
-            if (G->comm_type == GX_UNKNOWN)
-                game_io_printf("What did you just say?\n");
-        } while (G->comm_type == GX_UNKNOWN);
+    game_command(G);
 
-        switch (G->comm_type)
-        {
-        case GD_NEW:
-            game_comm_dot_new(G);
-            break;
-        case GD_DUMP:
-            game_comm_dot_dump(G);
-            break;
-        case GD_RESTORE:
-            game_comm_dot_restore(G);
-            break;
-        case GD_NOCLEAR:
-            game_comm_dot_noclear(G);
-            break;
-        case GD_SAVE:
-            if (!game_has_flag(G, GOPT_IN_LOAD))
-                game_comm_dot_save(G, 0);
+    /* The commands of .load come from its file */
+    while (G->done == NULL && game_has_flag(G, GOPT_IN_LOAD))
+    {
+        game_read_command(G);
+
+        if (G->done == NULL)
+            game_command(G);
+    }
+}
+
+int game_idle(game_p G)
+{
+    game_cold_p C = G->cold;
+
+    if (C == NULL)
+        return 1;
+
+    /* A search over by itself only has its thread left to join */
+    if (C->analysis.running &&
+        __atomic_load_n(&C->analysis.finished, __ATOMIC_ACQUIRE))
+        game_analysis_stop(G);
+
+    if (C->analysis.running || C->analysis.ponder || C->book.base != NULL ||
+        C->explore.base != NULL || game_has_flag(G, GOPT_IN_LOAD))
+        return 0;
+
+    game_cold_put(G);
+
+    return 1;
+}
+
+void game_end(game_p G)
+{
+    if (G->cold != NULL)
+    {
+        game_analysis_stop(G);
+        book_close(&G->cold->book);
+        explore_close(&G->cold->explore);
+        game_cold_put(G);
+    }
+
+    game_io_close(&G->io);
+    history_close(&G->history);
+}
+
+/* RETURN
+ * 0 (and G->done set) if memory could not be allocated.
+ */
+static int game_cold_get(game_p G)
+{
+    if (G->cold != NULL)
+        return 1;
+
+    if (G->pool != NULL)
+        G->cold = pool_get(G->pool);
+    else
+        G->cold = malloc(sizeof(struct game_cold_t));
+
+    if (G->cold == NULL)
+    {
+        G->done = GAME_DONE_NO_MEMORY;
+        return 0;
+    }
+
+    memset(G->cold, 0, sizeof(struct game_cold_t));
+    game_msg_init(&G->cold->message, &G->io);
+
+    return 1;
+}
+
+static void game_cold_put(game_p G)
+{
+    if (G->pool != NULL)
+        pool_put(G->pool, G->cold);
+    else
+        free(G->cold);
+
+    G->cold = NULL;
+}
+
+static void game_prompt(game_p G)
+{
+    if (game_has_flag(G, GOPT_CLEAR))
+        clear(G->io.out);
+
+    game_refresh(G);
+    game_io_printf(&G->io, "Command: ");
+}
+
+static void game_command(game_p G)
+{
+    if (game_has_flag(G, GOPT_REC))
+        history_println(&G->history, G->cold->comm_buf);
+
+    /* Remove trailing \n or \r */
+    trim_right(G->cold->comm_buf);
+    trim_left(G->cold->comm_buf);
+
+    game_decode_command(G);
+
+    if (G->done != NULL)
+        return;
+
+    if (G->comm_type == GX_UNKNOWN)
+    {
+        game_io_printf(&G->io, "What did you just say?\n");
+        game_io_printf(&G->io, "Command: ");
+        return;
+    }
+
+    /* Tablebases are shared by the process (see tb.h) */
+    if (game_has_flag(G, GOPT_REMOTE) &&
+        (G->comm_type == GD_TBGEN || G->comm_type == GD_TBLOAD))
+    {
+        game_msg_append(
+            &G->cold->message, "not available in server sessions\n"
+        );
+        G->comm_type = GX_IGNORE;
+    }
+
+    switch (G->comm_type)
+    {
+    case GD_NEW:
+        game_comm_dot_new(G);
+        break;
+    case GD_DUMP:
+        game_comm_dot_dump(G, 0);
+        break;
+    case GD_DUMP_APPEND:
+        game_comm_dot_dump(G, 1);
+        break;
+    case GD_RESTORE:
+        game_comm_dot_restore(G, 0);
+        break;
+    case GD_RESTORE_AT:
+        game_comm_dot_restore(G, 1);
+        break;
+    case GD_NOCLEAR:
+        game_comm_dot_noclear(G);
+        break;
+    case GD_SAVE:
+        if (!game_has_flag(G, GOPT_IN_LOAD))
+            game_comm_dot_save(G, 0);
 #ifdef DEBUG
-            else
-                fprintf(stderr, "skipped GD_SAVE due to GOPT_IN_LOAD.\n");
+        else
+            fprintf(stderr, "skipped GD_SAVE due to GOPT_IN_LOAD.\n");
 #endif
-            break;
-        case GD_SAVE_FORCE:
-            if (!game_has_flag(G, GOPT_IN_LOAD))
-                game_comm_dot_save(G, 1);
+        break;
+    case GD_SAVE_FORCE:
+        if (!game_has_flag(G, GOPT_IN_LOAD))
+            game_comm_dot_save(G, 1);
 #ifdef DEBUG
-            else
-                fprintf(stderr, "skipped GD_SAVE_FORCE due to GOPT_IN_LOAD.\n");
+        else
+            fprintf(stderr, "skipped GD_SAVE_FORCE due to GOPT_IN_LOAD.\n");
 #endif
-            break;
-        case GD_COMMENT:
-            if (game_has_flag(G, GOPT_IN_LOAD))
-                game_comm_dot_comment(G);
-            break;
-        case GD_LOAD:
-            game_comm_dot_load(G);
-            break;
-        case GD_NO_RECORD:
-            game_comm_dot_norecord(G);
-            break;
-        case GD_RECORD:
-            game_comm_dot_record(G);
-            break;
-
-        case GQ_LIST:
-            game_comm_qm_list(G);
-            break;
-
-        case GE_CLEAR:
-            game_comm_eq_clear(G);
-            break;
-        case GE_SET:
-            game_comm_eq_set(G);
-            break;
-        case GE_ASSERT:
-            game_comm_eq_assert(G);
-            break;
-
-        case GP_MOVE:
-            game_comm_play_move(G);
-            break;
-        case GX_IGNORE:
-            break;
-        }
-    }
-
-    history_close();
+        break;
+    case GD_COMMENT:
+        if (game_has_flag(G, GOPT_IN_LOAD))
+            game_comm_dot_comment(G);
+        break;
+    case GD_LOAD:
+        game_comm_dot_load(G);
+        break;
+    case GD_NO_RECORD:
+        game_comm_dot_norecord(G);
+        break;
+    case GD_RECORD:
+        game_comm_dot_record(G);
+        break;
+    case GD_BOOK:
+        game_comm_dot_book(G);
+        break;
+    case GD_BOOK_MOVE:
+        game_comm_dot_book_move(G);
+        break;
+    case GD_EXPLORE:
+        game_comm_dot_explore(G);
+        break;
+    case GD_TBGEN:
+        game_comm_dot_tbgen(G);
+        break;
+    case GD_TBMOVE:
+        game_comm_dot_tbmove(G);
+        break;
+    case GD_TBSAVE:
+        game_comm_dot_tbsave(G);
+        break;
+    case GD_TBLOAD:
+        game_comm_dot_tbload(G);
+        break;
+    case GD_ANALYZE:
+        game_comm_dot_analyze(G);
+        break;
+    case GD_STOP:
+        game_comm_dot_stop(G);
+        break;
+    case GD_PONDER:
+        game_comm_dot_ponder(G);
+        break;
+
+    case GQ_LIST:
+        game_comm_qm_list(G);
+        break;
+    case GQ_FEN:
+        game_comm_qm_fen(G);
+        break;
+    case GQ_BOOK:
+        game_comm_qm_book(G);
+        break;
+    case GQ_EXPLORE:
+        game_comm_qm_explore(G);
+        break;
+    case GQ_DTM:
+        game_comm_qm_dtm(G);
+        break;
+    case GQ_KPK:
+        game_comm_qm_kpk(G);
+        break;
+
+    case GE_CLEAR:
+        game_comm_eq_clear(G);
+        break;
+    case GE_SET:
+        game_comm_eq_set(G);
+        break;
+    case GE_ASSERT:
+        game_comm_eq_assert(G);
+        break;
+    case GE_FEN:
+        game_comm_eq_fen(G);
+        break;
+
+    case GP_MOVE:
+        game_comm_play_move(G);
+        break;
+    case GX_IGNORE:
+        break;
+    }
+
+    if (G->done == NULL)
+        game_prompt(G);
 }
 
 static void game_read_command(game_p G)
 {
-    if (!game_io_gets(G->comm_buf, sizeof(G->comm_buf)))
+    if (!game_io_gets(&G->io, G->cold->comm_buf, sizeof(G->cold->comm_buf)))
     {
         if (game_has_flag(G, GOPT_IN_LOAD))
         {
-            G->comm_buf[0] = '\0';
+            G->cold->comm_buf[0] = '\0';
             game_unset_flag(G, GOPT_IN_LOAD);
-            game_msg_append(&G->message, "Loaded.\n");
+            game_msg_append(&G->cold->message, "Loaded.\n");
         }
         else
         {
@@ -168,79 +390,132 @@ static void game_read_command(game_p G)
             return;
         }
     }
-
-    if (game_has_flag(G, GOPT_REC))
-        history_println(G->comm_buf);
-
-    /* Remove trailing \n or \r */
-    trim_right(G->comm_buf);
-    trim_left(G->comm_buf);
 }
 
 static void game_decode_command(game_p G)
 {
     size_t len;
 
-    if (streq_ci(G->comm_buf, "quit"))
+    if (streq_ci(G->cold->comm_buf, "quit"))
     {
         G->done = GAME_DONE_COMM_QUIT;
         return;
     }
-    else if (streq_ci(G->comm_buf, ""))
+    else if (streq_ci(G->cold->comm_buf, ""))
     {
         G->comm_type = GX_IGNORE;
         return;
     }
 
-    switch (G->comm_buf[0])
+    switch (G->cold->comm_buf[0])
     {
     case '.':
-        if (strneq_ci(G->comm_buf + 1, "norecord", 8))
+        if (strneq_ci(G->cold->comm_buf + 1, "norecord", 8))
         {
             G->comm_type = GD_NO_RECORD;
             return;
         }
-        if (strneq_ci(G->comm_buf + 1, "record", 6))
+        if (strneq_ci(G->cold->comm_buf + 1, "record", 6))
         {
             G->comm_type = GD_RECORD;
             return;
         }
-        if (strneq_ci(G->comm_buf + 1, "dump", 4))
+        if (strneq_ci(G->cold->comm_buf + 1, "dump+", 5))
+        {
+            G->comm_type = GD_DUMP_APPEND;
+            return;
+        }
+        if (strneq_ci(G->cold->comm_buf + 1, "dump", 4))
         {
             G->comm_type = GD_DUMP;
             return;
         }
-        if (strneq_ci(G->comm_buf + 1, "restore", 7))
+        if (strneq_ci(G->cold->comm_buf + 1, "restore-at", 10))
+        {
+            G->comm_type = GD_RESTORE_AT;
+            return;
+        }
+        if (strneq_ci(G->cold->comm_buf + 1, "restore", 7))
         {
             G->comm_type = GD_RESTORE;
             return;
         }
-        if (strneq_ci(G->comm_buf + 1, "new", 3))
+        if (strneq_ci(G->cold->comm_buf + 1, "bookmove", 8))
+        {
+            G->comm_type = GD_BOOK_MOVE;
+            return;
+        }
+        if (strneq_ci(G->cold->comm_buf + 1, "book", 4))
+        {
+            G->comm_type = GD_BOOK;
+            return;
+        }
+        if (strneq_ci(G->cold->comm_buf + 1, "explore", 7))
+        {
+            G->comm_type = GD_EXPLORE;
+            return;
+        }
+        if (strneq_ci(G->cold->comm_buf + 1, "tbgen", 5))
+        {
+            G->comm_type = GD_TBGEN;
+            return;
+        }
+        if (strneq_ci(G->cold->comm_buf + 1, "tbmove", 6))
+        {
+            G->comm_type = GD_TBMOVE;
+            return;
+        }
+        if (strneq_ci(G->cold->comm_buf + 1, "tbsave", 6))
+        {
+            G->comm_type = GD_TBSAVE;
+            return;
+        }
+        if (strneq_ci(G->cold->comm_buf + 1, "tbload", 6))
+        {
+            G->comm_type = GD_TBLOAD;
+            return;
+        }
+        if (strneq_ci(G->cold->comm_buf + 1, "analyze", 7))
+        {
+            G->comm_type = GD_ANALYZE;
+            return;
+        }
+        if (strneq_ci(G->cold->comm_buf + 1, "stop", 4))
+        {
+            G->comm_type = GD_STOP;
+            return;
+        }
+        if (strneq_ci(G->cold->comm_buf + 1, "ponder", 6))
+        {
+            G->comm_type = GD_PONDER;
+            return;
+        }
+        if (strneq_ci(G->cold->comm_buf + 1, "new", 3))
         {
             G->comm_type = GD_NEW;
             return;
         }
-        if (strneq_ci(G->comm_buf + 1, "noclear", 7))
+        if (strneq_ci(G->cold->comm_buf + 1, "noclear", 7))
         {
             G->comm_type = GD_NOCLEAR;
             return;
         }
-        if (strneq_ci(G->comm_buf + 1, "save!", 5))
+        if (strneq_ci(G->cold->comm_buf + 1, "save!", 5))
         {
             G->comm_type = GD_SAVE_FORCE;
             return;
         }
-        if (strneq_ci(G->comm_buf + 1, "save", 4))
+        if (strneq_ci(G->cold->comm_buf + 1, "save", 4))
         {
             G->comm_type = GD_SAVE;
             return;
         }
-        if (strneq_ci(G->comm_buf + 1, "load", 4))
+        if (strneq_ci(G->cold->comm_buf + 1, "load", 4))
         {
             G->comm_type = GD_LOAD;
             return;
         }
-        if (strneq_ci(G->comm_buf + 1, ".", 1))
+        if (strneq_ci(G->cold->comm_buf + 1, ".", 1))
         {
             G->comm_type = GD_COMMENT;
             return;
@@ -248,39 +523,57 @@ static void game_decode_command(game_p G)
         break;
 
     case '=':
-        if (strneq_ci(G->comm_buf + 1, "clear", 5))
+        if (strneq_ci(G->cold->comm_buf + 1, "clear", 5))
         {
             G->comm_type = GE_CLEAR;
             return;
         }
-        if (strneq_ci(G->comm_buf + 1, "set", 3))
+        if (strneq_ci(G->cold->comm_buf + 1, "set", 3))
         {
             G->comm_type = GE_SET;
             return;
         }
-        if (strneq_ci(G->comm_buf + 1, "assert", 6))
+        if (strneq_ci(G->cold->comm_buf + 1, "assert", 6))
         {
             G->comm_type = GE_ASSERT;
             return;
         }
+        if (strneq_ci(G->cold->comm_buf + 1, "fen", 3))
+        {
+            G->comm_type = GE_FEN;
+            return;
+        }
         break;
 
     case '?':
-        trim(G->comm_buf + 1);
-        G->comm_type = GQ_LIST;
+        trim(G->cold->comm_buf + 1);
+        if (streq_ci(G->cold->comm_buf + 1, "fen"))
+            G->comm_type = GQ_FEN;
+        else if (streq_ci(G->cold->comm_buf + 1, "book"))
+            G->comm_type = GQ_BOOK;
+        else if (streq_ci(G->cold->comm_buf + 1, "explore"))
+            G->comm_type = GQ_EXPLORE;
+        else if (streq_ci(G->cold->comm_buf + 1, "dtm"))
+            G->comm_type = GQ_DTM;
+        else if (streq_ci(G->cold->comm_buf + 1, "kpk"))
+            G->comm_type = GQ_KPK;
+        else
+            G->comm_type = GQ_LIST;
         return;
         break;
 
     default:
-        len = strlen(G->comm_buf);
+        len = strlen(G->cold->comm_buf);
         if (len >= 4 && len <= 5)
         {
-            move_init(&G->comm_move, G->comm_buf, sizeof(G->comm_buf));
+            move_init(
+                &G->comm_move, G->cold->comm_buf, sizeof(G->cold->comm_buf)
+            );
             G->comm_type = GP_MOVE;
 
-            /* If len == 4 G->comm_buf[4] is '\0' and hence it gets correctly
-             * decoded to cpEEMPTY */
-            G->pawn_morph = piece_from_char(G->comm_buf[4], G->turn);
+            /* If len == 4 G->cold->comm_buf[4] is '\0' and hence it gets
+             * correctly decoded to cpEEMPTY */
+            G->pawn_morph = piece_from_char(G->cold->comm_buf[4], G->turn);
             return;
         }
     }
@@ -299,7 +592,7 @@ static void game_comm_play_move(game_p G)
     if (G->checkmate != cpEEMPTY)
     {
         game_msg_vappend(
-            &G->message,
+            &G->cold->message,
             "It's checkmate, no good in trying to play pal. Stacce!",
             NULL
         );
@@ -312,60 +605,110 @@ static void game_comm_play_move(game_p G)
     if (illegal_move != NULL)
     {
         game_msg_vappend(
-            &G->message, "Illegal move: ", illegal_move, "\n", NULL
+            &G->cold->message, "Illegal move: ", illegal_move, "\n", NULL
         );
-        G->comm_buf[0] = '\0';
+        G->cold->comm_buf[0] = '\0';
     }
     else
     {
         board_exec(&G->board, &G->comm_move, G->pawn_morph);
         game_next_turn(G);
+
+        /* A running analysis is about the previous position */
+        if (G->cold->analysis.ponder)
+            game_analysis_start(G, SEARCH_MAX_DEPTH);
+        else
+            game_analysis_stop(G);
     }
 
     if (illegal_move == ILLEGAL_MOVE_CHECK)
     {
         coord_to_str(&whence_check, buf, sizeof(buf));
-        game_msg_vappend(&G->message, buf, " would take over the King\n", NULL);
+        game_msg_vappend(
+            &G->cold->message, buf, " would take over the King\n", NULL
+        );
     }
 }
 
-static void game_comm_dot_new(game_p G) { game_init(G, G->opts); }
+static void game_comm_dot_new(game_p G) { game_reset(G); }
+
+/* Back to the initial position with an empty history, keeping what is not
+ * part of the game: the streams, the book and the index */
+static void game_reset(game_p G)
+{
+    game_analysis_stop(G);
+    G->cold->analysis.ponder = 0;
+    game_msg_clear(&G->cold->message);
+
+    history_close(&G->history);
+    history_init(&G->history);
+
+    board_init(&G->board);
+    G->turn       = cpWTURN;
+    G->checkmate  = cpEEMPTY;
+    G->pawn_morph = cpEEMPTY;
+    G->comm_type  = GX_UNKNOWN;
+}
 
-static void game_comm_dot_dump(game_p G)
+static void game_comm_dot_dump(game_p G, int append)
 {
     const char* fpath;
+    const char* err;
     size_t      spc;
+    long        size;
     FILE*       fp;
-    int         ok;
 
-    for (spc = 0; G->comm_buf[spc] && G->comm_buf[spc] != ' '; ++spc)
+    for (spc = 0; G->cold->comm_buf[spc] && G->cold->comm_buf[spc] != ' ';
+         ++spc)
         ;
 
-    fpath = G->comm_buf + spc + 1;
+    fpath = G->cold->comm_buf + spc + 1;
 
-    fp    = fopen(fpath, "w+");
+    fp    = fopen(fpath, append ? "ab+" : "wb");
     if (fp == NULL)
     {
-        game_msg_append(&G->message, "could not open file");
+        game_msg_append(&G->cold->message, "could not open file");
         return;
     }
 
-    ok = board_dump(&G->board, fp);
-    if (!ok)
+    size = 0;
+    if (append && (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0))
     {
-        game_msg_append(&G->message, "could not write board to file");
-        return;
+        err = BOARD_DUMP_ERR_READ;
+    }
+    else if (size > 0)
+    {
+        /* Appending to an existing dump: its header must be valid and it must
+         * end with a whole record, or the record would be appended after
+         * garbage. A seek is required between reading and writing the same
+         * stream */
+        rewind(fp);
+        err = board_restore_header(fp);
+        if (err == NULL &&
+            (size - BOARD_DUMP_HEADER_SIZE) % BOARD_DUMP_RECORD_SIZE != 0)
+            err = BOARD_ARCHIVE_ERR_SIZE;
+        fseek(fp, 0, SEEK_END);
+    }
+    else
+    {
+        err = board_dump_header(fp);
     }
 
-    ok = (int)fwrite(&G->turn, 1, sizeof(G->turn), fp);
-    if (ok != (int)sizeof(G->turn))
+    if (err == NULL)
+        err = board_dump(&G->board, G->turn, fp);
+
+    if (fclose(fp) != 0 && err == NULL)
+        err = BOARD_DUMP_ERR_WRITE;
+
+    if (err != NULL)
     {
-        game_msg_append(&G->message, "could not write current turn to file");
+        game_msg_vappend(
+            &G->cold->message, "could not dump: ", err, "\n", NULL
+        );
         return;
     }
 
-    game_msg_append(&G->message, "dump done");
-    fclose(fp);
+    game_msg_append(&G->cold->message, append ? "dump appended" : "dump done");
 }
 
 static void game_comm_dot_save(game_p G, int force)
@@ -376,10 +719,11 @@ static void game_comm_dot_save(game_p G, int force)
     int         ok;
     struct stat st;
 
-    for (spc = 0; G->comm_buf[spc] && G->comm_buf[spc] != ' '; ++spc)
+    for (spc = 0; G->cold->comm_buf[spc] && G->cold->comm_buf[spc] != ' ';
+         ++spc)
         ;
 
-    fpath = G->comm_buf + spc + 1;
+    fpath = G->cold->comm_buf + spc + 1;
 
     if (!force)
     {
@@ -387,7 +731,7 @@ static void game_comm_dot_save(game_p G, int force)
         if (ok)
         {
             game_msg_vappend(
-                &G->message,
+                &G->cold->message,
                 "ERROR! COULD NOT SAVE! ",
                 fpath,
                 " already exists.\n",
@@ -401,71 +745,429 @@ static void game_comm_dot_save(game_p G, int force)
             {
                 strerror_r(errno, mverr, sizeof(mverr));
                 game_msg_vappend(
-                    &G->message, "ERROR! COULD NOT SAVE! ", mverr, "\n", NULL
+                    &G->cold->message,
+                    "ERROR! COULD NOT SAVE! ",
+                    mverr,
+                    "\n",
+                    NULL
                 );
             }
         }
     }
 
-    ok = history_mv(fpath);
+    ok = history_mv(&G->history, fpath);
 
     if (ok)
     {
-        game_msg_vappend(&G->message, "saved to ", fpath, "\n", NULL);
+        game_msg_vappend(&G->cold->message, "saved to ", fpath, "\n", NULL);
         return;
     }
 
     strerror_r(errno, mverr, sizeof(mverr));
-    game_msg_vappend(&G->message, "ERROR! COULD NOT SAVE! ", mverr, "\n", NULL);
+    game_msg_vappend(
+        &G->cold->message, "ERROR! COULD NOT SAVE! ", mverr, "\n", NULL
+    );
+}
+
+static void game_comm_dot_restore(game_p G, int at)
+{
+    struct board_archive_t A;
+    const char*            fpath;
+    const char*            err;
+    char*                  endp;
+    size_t                 spc;
+    unsigned long          index;
+
+    for (spc = 0; G->cold->comm_buf[spc] && G->cold->comm_buf[spc] != ' ';
+         ++spc)
+        ;
+
+    fpath = G->cold->comm_buf + spc + 1;
+    index = 0;
+
+    /* .restore-at N fpath */
+    if (at)
+    {
+        index = strtoul(fpath, &endp, 10);
+        if (endp == fpath || *endp != ' ')
+        {
+            game_msg_append(
+                &G->cold->message, "bad format; .restore-at N file\n"
+            );
+            return;
+        }
+
+        fpath = endp + 1;
+    }
+
+    /* The analysis is of the board being replaced */
+    game_analysis_stop(G);
+    G->cold->analysis.ponder = 0;
+
+    err = board_archive_open(&A, fpath);
+    if (err == NULL)
+    {
+        err = board_archive_get(&A, index, &G->board, &G->turn);
+        board_archive_close(&A);
+    }
+
+    if (err != NULL)
+    {
+        game_msg_vappend(
+            &G->cold->message, "could not restore: ", err, "\n", NULL
+        );
+        return;
+    }
+
+    /* A new position: whatever ended the previous one is gone */
+    G->checkmate  = cpEEMPTY;
+    G->pawn_morph = cpEEMPTY;
+
+    game_msg_append(&G->cold->message, "restore done");
 }
 
-static void game_comm_dot_restore(game_p G)
+static void game_comm_dot_book(game_p G)
 {
     const char* fpath;
+    const char* err;
     size_t      spc;
-    FILE*       fp;
-    int         ok;
 
-    for (spc = 0; G->comm_buf[spc] && G->comm_buf[spc] != ' '; ++spc)
+    for (spc = 0; G->cold->comm_buf[spc] && G->cold->comm_buf[spc] != ' ';
+         ++spc)
         ;
 
-    fpath = G->comm_buf + spc + 1;
+    fpath = G->cold->comm_buf + spc + 1;
 
-    fp    = fopen(fpath, "r");
-    if (fp == NULL)
+    book_close(&G->cold->book);
+    err = book_open(&G->cold->book, fpath);
+    if (err != NULL)
+    {
+        game_msg_vappend(
+            &G->cold->message, "could not open book: ", err, "\n", NULL
+        );
+        return;
+    }
+
+    game_msg_append(&G->cold->message, "book opened\n");
+}
+
+static void game_comm_dot_book_move(game_p G)
+{
+    struct book_move_t E;
+    struct coord_t     whence;
+    size_t             first;
+    size_t             count;
+    size_t             i;
+    int                best = -1;
+
+    if (G->cold->book.base == NULL)
     {
-        game_msg_append(&G->message, "could not open file");
+        game_msg_append(&G->cold->message, "no book: see .book\n");
         return;
     }
 
-    ok = board_restore(&G->board, fp);
-    if (!ok)
+    count = book_find(&G->cold->book, book_key(&G->board, G->turn), &first);
+
+    /* Play the heaviest move the board accepts */
+    for (i = first; i < first + count; ++i)
     {
-        game_msg_append(&G->message, "could not read board from file");
+        book_entry(&G->cold->book, i, &G->board, G->turn, &E);
+        if (E.castling || (int)E.weight <= best)
+            continue;
+
+        if (board_check_move(
+                &G->board, &E.move, E.pawn_morph, G->turn, &whence
+            ) != NULL)
+            continue;
+
+        best          = E.weight;
+        G->comm_move  = E.move;
+        G->pawn_morph = E.pawn_morph;
+    }
+
+    if (best == -1)
+    {
+        game_msg_append(&G->cold->message, "no book move\n");
         return;
     }
 
-    ok = (int)fread(&G->turn, 1, sizeof(G->turn), fp);
-    if (ok != (int)sizeof(G->turn))
+    game_comm_play_move(G);
+}
+
+static void game_comm_dot_explore(game_p G)
+{
+    const char* fpath;
+    const char* err;
+    size_t      spc;
+
+    for (spc = 0; G->cold->comm_buf[spc] && G->cold->comm_buf[spc] != ' ';
+         ++spc)
+        ;
+
+    fpath = G->cold->comm_buf + spc + 1;
+
+    explore_close(&G->cold->explore);
+    err = explore_open(&G->cold->explore, fpath);
+    if (err != NULL)
     {
-        game_msg_append(&G->message, "could not read turn from file");
+        game_msg_vappend(
+            &G->cold->message, "could not open index: ", err, "\n", NULL
+        );
         return;
     }
 
-    game_msg_append(&G->message, "restore done");
-    fclose(fp);
+    game_msg_append(&G->cold->message, "index opened\n");
 }
 
-static void game_comm_eq_clear(game_p G)
+static void game_comm_dot_tbgen(game_p G)
 {
-    struct coord_t src;
+    const char* sig;
+    const char* err;
+    char        buf[64];
+    size_t      spc;
+    double      start;
+
+    for (spc = 0; G->cold->comm_buf[spc] && G->cold->comm_buf[spc] != ' ';
+         ++spc)
+        ;
+
+    sig   = G->cold->comm_buf + spc + 1;
 
-    for (src.row = 0; src.row < 8; ++src.row)
-        for (src.col = 0; src.col < 8; ++src.col)
-            board_set_at(&G->board, &src, cpEEMPTY);
+    start = clock_ms();
+    err   = tb_generate(sig, 0);
+    if (err != NULL)
+    {
+        game_msg_vappend(
+            &G->cold->message, "could not generate table: ", err, "\n", NULL
+        );
+        return;
+    }
 
-    G->board.wking.row = -1;
-    G->board.bking.row = -1;
+    sprintf(buf, " generated in %.0f ms\n", clock_ms() - start);
+    game_msg_vappend(&G->cold->message, "table ", sig, buf, NULL);
+}
+
+static void game_comm_dot_tbmove(game_p G)
+{
+    const char* err;
+
+    err = tb_best_move(&G->board, G->turn, &G->comm_move, &G->pawn_morph);
+    if (err != NULL)
+    {
+        game_msg_vappend(&G->cold->message, "no table move: ", err, "\n", NULL);
+        return;
+    }
+
+    game_comm_play_move(G);
+}
+
+static void game_comm_dot_tbsave(game_p G)
+{
+    char*       sig;
+    const char* fpath;
+    const char* err;
+    size_t      spc;
+
+    for (spc = 0; G->cold->comm_buf[spc] && G->cold->comm_buf[spc] != ' ';
+         ++spc)
+        ;
+
+    sig = G->cold->comm_buf + spc + 1;
+
+    for (spc = 0; sig[spc] && sig[spc] != ' '; ++spc)
+        ;
+
+    if (sig[spc] == '\0')
+    {
+        game_msg_append(&G->cold->message, "usage: .tbsave SIG FILE\n");
+        return;
+    }
+
+    sig[spc] = '\0';
+    fpath    = sig + spc + 1;
+
+    err      = tb_save(sig, fpath);
+    if (err != NULL)
+    {
+        game_msg_vappend(
+            &G->cold->message, "could not save table: ", err, "\n", NULL
+        );
+        return;
+    }
+
+    game_msg_append(&G->cold->message, "table saved\n");
+}
+
+static void game_comm_dot_tbload(game_p G)
+{
+    const char* fpath;
+    const char* err;
+    size_t      spc;
+
+    for (spc = 0; G->cold->comm_buf[spc] && G->cold->comm_buf[spc] != ' ';
+         ++spc)
+        ;
+
+    fpath = G->cold->comm_buf + spc + 1;
+
+    err   = tb_load(fpath);
+    if (err != NULL)
+    {
+        game_msg_vappend(
+            &G->cold->message, "could not load table: ", err, "\n", NULL
+        );
+        return;
+    }
+
+    game_msg_append(&G->cold->message, "table loaded\n");
+}
+
+static void game_comm_dot_analyze(game_p G)
+{
+    size_t spc;
+    int    depth;
+
+    for (spc = 0; G->cold->comm_buf[spc] && G->cold->comm_buf[spc] != ' ';
+         ++spc)
+        ;
+
+    depth = G->cold->comm_buf[spc] ? atoi(G->cold->comm_buf + spc + 1) : 0;
+    if (depth <= 0 || depth > SEARCH_MAX_DEPTH)
+        depth = SEARCH_MAX_DEPTH;
+
+    game_analysis_start(G, depth);
+}
+
+static void game_comm_dot_stop(game_p G)
+{
+    if (!G->cold->analysis.running)
+    {
+        game_msg_append(&G->cold->message, "no analysis running\n");
+        return;
+    }
+
+    game_analysis_stop(G);
+}
+
+static void game_comm_dot_ponder(game_p G)
+{
+    size_t spc;
+
+    for (spc = 0; G->cold->comm_buf[spc] && G->cold->comm_buf[spc] != ' ';
+         ++spc)
+        ;
+
+    if (streq_ci(G->cold->comm_buf + spc + 1, "on"))
+    {
+        G->cold->analysis.ponder = 1;
+        game_analysis_start(G, SEARCH_MAX_DEPTH);
+    }
+    else if (streq_ci(G->cold->comm_buf + spc + 1, "off"))
+        G->cold->analysis.ponder = 0;
+    else
+        game_msg_append(&G->cold->message, "usage: .ponder on|off\n");
+}
+
+static void game_analysis_start(game_p G, int depth)
+{
+    game_analysis_p A = &G->cold->analysis;
+
+    game_analysis_stop(G);
+
+    search_init(&A->search);
+    A->search.max_depth = depth;
+    A->search.report    = game_analysis_report;
+    A->board            = G->board;
+    A->turn             = G->turn;
+    A->search.ctx       = &G->io;
+    A->finished         = 0;
+
+    if (pthread_create(&A->thread, NULL, game_analysis_run, A) != 0)
+    {
+        game_msg_append(&G->cold->message, "could not start the analysis\n");
+        return;
+    }
+
+    A->running = 1;
+}
+
+static void game_analysis_stop(game_p G)
+{
+    if (!G->cold->analysis.running)
+        return;
+
+    /* Seen by the search within a node */
+    __atomic_store_n(&G->cold->analysis.search.stop, 1, __ATOMIC_RELAXED);
+    pthread_join(G->cold->analysis.thread, NULL);
+    G->cold->analysis.running = 0;
+}
+
+static void* game_analysis_run(void* arg)
+{
+    game_analysis_p A  = arg;
+    game_io_p       IO = A->search.ctx;
+    char            buf[6];
+
+    if (search_run(&A->search, &A->board, A->turn))
+    {
+        game_analysis_move_str(&A->search, buf);
+        game_io_printf(
+            IO,
+            "analysis %s: best %s\n",
+            A->search.stopped ? "stopped" : "done",
+            buf
+        );
+    }
+    else
+        game_io_printf(IO, "analysis done: no legal move\n");
+
+    game_io_flush(IO);
+
+    __atomic_store_n(&A->finished, 1, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+static void game_analysis_report(void* ctx, search_p S)
+{
+    game_io_p IO = ctx;
+    char      buf[6];
+    char      score[32];
+    int       mate = search_mate_in(S->score);
+
+    game_analysis_move_str(S, buf);
+
+    if (mate != 0)
+        sprintf(score, "mate in %d", mate);
+    else
+        sprintf(score, "%+.2f", S->score / 100.0);
+
+    game_io_printf(
+        IO,
+        "analysis depth %d: %s %s, %lu nodes\n",
+        S->depth,
+        buf,
+        score,
+        S->nodes
+    );
+    game_io_flush(IO);
+}
+
+static void game_analysis_move_str(search_p S, char* buf)
+{
+    coord_to_str(&S->best.source, buf, 3);
+    coord_to_str(&S->best.dest, buf + 2, 3);
+    buf[4] = S->best_morph == cpEEMPTY ? '\0' : piece_to_char(S->best_morph);
+    buf[5] = '\0';
+}
+
+static void game_comm_eq_clear(game_p G)
+{
+    board_clear(&G->board);
+    board_index(&G->board);
+
+    G->board.wking.row = G->board.wking.col = -1;
+    G->board.bking.row = G->board.bking.col = -1;
 }
 
 static void game_comm_eq_set(game_p G)
@@ -476,7 +1178,7 @@ static void game_comm_eq_set(game_p G)
     int            piece;
     struct coord_t dst;
 
-    comm_i = G->comm_buf + 4; /* Command starts at =set ... */
+    comm_i = G->cold->comm_buf + 4; /* Command starts at =set ... */
 
     while (*comm_i && *(comm_i++) == ' ')
         ;
@@ -488,7 +1190,9 @@ static void game_comm_eq_set(game_p G)
 
     if (sscanf(comm_i, "%d", &piece) != 1)
     {
-        game_msg_append(&G->message, "bad format || could not read piece");
+        game_msg_append(
+            &G->cold->message, "bad format || could not read piece"
+        );
         return;
     }
 
@@ -496,13 +1200,13 @@ static void game_comm_eq_set(game_p G)
 
     if (board_coord_out_of_bound(&dst))
     {
-        game_msg_append(&G->message, "bad format");
+        game_msg_append(&G->cold->message, "bad format");
         return;
     }
 
     if (piece_to_char((piece_t)piece) == 'E')
     {
-        game_msg_append(&G->message, "bad argument; unknown piece");
+        game_msg_append(&G->cold->message, "bad argument; unknown piece");
         return;
     }
 
@@ -511,7 +1215,7 @@ static void game_comm_eq_set(game_p G)
         if (!board_coord_out_of_bound(&G->board.wking))
         {
             game_msg_append(
-                &G->message,
+                &G->cold->message,
                 "White King has been moved (there can only be one King for "
                 "each player)"
             );
@@ -526,7 +1230,7 @@ static void game_comm_eq_set(game_p G)
         if (!board_coord_out_of_bound(&G->board.bking))
         {
             game_msg_append(
-                &G->message,
+                &G->cold->message,
                 "Black King has been moved (there can only be one King for "
                 "each player)"
             );
@@ -553,10 +1257,10 @@ static void game_comm_qm_list(game_p G)
     piece_t        king_under_check;
     struct coord_t whence;
 
-    coord_init_by_str(&src, G->comm_buf + 1);
+    coord_init_by_str(&src, G->cold->comm_buf + 1);
     if (board_coord_out_of_bound(&src))
     {
-        game_msg_append(&G->message, "Out of bound.\n");
+        game_msg_append(&G->cold->message, "Out of bound.\n");
         return;
     }
 
@@ -564,9 +1268,9 @@ static void game_comm_qm_list(game_p G)
         board_list_moves(&G->board, &src, DST, GAME_MAX_MOVES_FOR_ONE_PIECE);
 
     if (ncord == 0)
-        game_msg_vappend(&G->message, "! No move\n", NULL);
+        game_msg_vappend(&G->cold->message, "! No move\n", NULL);
     else if (ncord == -1 || ncord > GAME_MAX_MOVES_FOR_ONE_PIECE)
-        game_msg_vappend(&G->message, "! ERR\n", NULL);
+        game_msg_vappend(&G->cold->message, "! ERR\n", NULL);
     else
     {
         for (cur = 0; cur < ncord; ++cur)
@@ -577,43 +1281,199 @@ static void game_comm_qm_list(game_p G)
                 board_under_check_part_w(&G->board, &src, DST + cur, &whence);
             if (king_under_check == cpEEMPTY)
             {
-                game_msg_vappend(&G->message, "> ", buf, "\n", NULL);
+                game_msg_vappend(&G->cold->message, "> ", buf, "\n", NULL);
             }
             else if ((king_under_check ^ G->turn) > 0)
             {
                 game_msg_vappend(
-                    &G->message,
+                    &G->cold->message,
                     "! ",
                     buf,
                     " NO GO would get under check by ",
                     NULL
                 );
                 coord_to_str(&whence, buf, sizeof(buf));
-                game_msg_vappend(&G->message, buf, "\n", NULL);
+                game_msg_vappend(&G->cold->message, buf, "\n", NULL);
             }
             else
             {
                 game_msg_vappend(
-                    &G->message, "> ", buf, " would check\n", NULL
+                    &G->cold->message, "> ", buf, " would check\n", NULL
                 );
             }
         }
     }
 }
 
+static void game_comm_qm_fen(game_p G)
+{
+    char buf[BOARD_FEN_LENGTH];
+
+    board_to_fen(&G->board, G->turn, buf, sizeof(buf));
+    game_msg_vappend(&G->cold->message, buf, "\n", NULL);
+}
+
+static void game_comm_qm_book(game_p G)
+{
+    struct book_move_t E;
+    char               buf[64];
+    size_t             first;
+    size_t             count;
+    size_t             i;
+    unsigned long      total;
+
+    if (G->cold->book.base == NULL)
+    {
+        game_msg_append(&G->cold->message, "no book: see .book\n");
+        return;
+    }
+
+    count = book_find(&G->cold->book, book_key(&G->board, G->turn), &first);
+    if (count == 0)
+    {
+        game_msg_append(&G->cold->message, "position not in book\n");
+        return;
+    }
+
+    for (total = 0, i = first; i < first + count; ++i)
+    {
+        book_entry(&G->cold->book, i, &G->board, G->turn, &E);
+        total += E.weight;
+    }
+
+    for (i = first; i < first + count; ++i)
+    {
+        book_entry(&G->cold->book, i, &G->board, G->turn, &E);
+
+        coord_to_str(&E.move.source, buf, 3);
+        coord_to_str(&E.move.dest, buf + 2, 3);
+        buf[4] = E.pawn_morph == cpEEMPTY ? '\0' : piece_to_char(E.pawn_morph);
+        buf[5] = '\0';
+
+        game_msg_vappend(&G->cold->message, buf, NULL);
+
+        sprintf(
+            buf,
+            " %u (%lu%%)%s\n",
+            (unsigned int)E.weight,
+            total == 0 ? 0 : E.weight * 100UL / total,
+            E.castling ? " castling, not implemented" : ""
+        );
+        game_msg_vappend(&G->cold->message, buf, NULL);
+    }
+}
+
+static void game_comm_qm_dtm(game_p G)
+{
+    const char* err;
+    char        buf[64];
+    int         dtm;
+
+    err = tb_probe(&G->board, G->turn, &dtm);
+    if (err != NULL)
+    {
+        game_msg_vappend(&G->cold->message, "no table: ", err, "\n", NULL);
+        return;
+    }
+
+    if (dtm == TB_DRAW)
+        strcpy(buf, "draw\n");
+    else if (dtm == TB_INVALID)
+        strcpy(buf, "not a legal position\n");
+    else if (dtm == 1)
+        strcpy(buf, "checkmate\n");
+    else
+        sprintf(
+            buf,
+            "%s mates in %d plies\n",
+            (dtm % 2 == 0) == (G->turn == cpWTURN) ? "WHITE" : "BLACK",
+            dtm - 1
+        );
+
+    game_msg_append(&G->cold->message, buf);
+}
+
+static void game_comm_qm_kpk(game_p G)
+{
+    int pieces = attack_count(~board_mask(&G->board, cpEEMPTY));
+    int pawns  = attack_count(
+        board_mask(&G->board, cpWPAWN) | board_mask(&G->board, cpBPAWN)
+    );
+
+    if (pieces != 3 || pawns != 1 || G->board.wking.row == -1 ||
+        G->board.bking.row == -1)
+    {
+        game_msg_append(&G->cold->message, "not a king and pawn versus king\n");
+        return;
+    }
+
+    game_msg_append(
+        &G->cold->message,
+        kpk_probe(&G->board, G->turn) ? "pawn wins\n" : "draw\n"
+    );
+}
+
+static void game_comm_qm_explore(game_p G)
+{
+    struct explore_entry_t E;
+    char                   buf[96];
+    size_t                 first;
+    size_t                 count;
+    size_t                 i;
+
+    if (G->cold->explore.base == NULL)
+    {
+        game_msg_append(&G->cold->message, "no index: see .explore\n");
+        return;
+    }
+
+    count = explore_find(
+        &G->cold->explore, explore_key(&G->board, G->turn), &first
+    );
+    if (count == 0)
+    {
+        game_msg_append(&G->cold->message, "position not in index\n");
+        return;
+    }
+
+    for (i = first; i < first + count; ++i)
+    {
+        explore_entry(&G->cold->explore, i, G->turn, &E);
+
+        coord_to_str(&E.move.source, buf, 3);
+        coord_to_str(&E.move.dest, buf + 2, 3);
+        buf[4] = E.pawn_morph == cpEEMPTY ? '\0' : piece_to_char(E.pawn_morph);
+        buf[5] = '\0';
+
+        game_msg_vappend(&G->cold->message, buf, NULL);
+
+        sprintf(
+            buf,
+            " %lu games: %lu white, %lu draw, %lu black\n",
+            (unsigned long)E.games[PGN_RESULT_UNKNOWN] +
+                E.games[PGN_RESULT_WHITE] + E.games[PGN_RESULT_DRAW] +
+                E.games[PGN_RESULT_BLACK],
+            (unsigned long)E.games[PGN_RESULT_WHITE],
+            (unsigned long)E.games[PGN_RESULT_DRAW],
+            (unsigned long)E.games[PGN_RESULT_BLACK]
+        );
+        game_msg_vappend(&G->cold->message, buf, NULL);
+    }
+}
+
 static void game_refresh(game_p G)
 {
     struct coord_t whence;
     char           buf[3];
 
-    whence.row = -1;
-    putchar('\n');
+    whence.row = whence.col = -1;
+    game_io_putc(&G->io, '\n');
 
     board_under_check_part(&G->board, &G->board.wking, &whence);
     if (whence.row != -1)
     {
         coord_to_str(&whence, buf, sizeof(buf));
-        game_io_printf("WHITE King is under check by %s!\n", buf);
+        game_io_printf(&G->io, "WHITE King is under check by %s!\n", buf);
     }
     else
     {
@@ -621,19 +1481,21 @@ static void game_refresh(game_p G)
         if (whence.row != -1)
         {
             coord_to_str(&whence, buf, sizeof(buf));
-            game_io_printf("BLACK King is under check by %s!\n", buf);
+            game_io_printf(
+                &G->io, "BLACK King is under check by %s!\n", buf
+            );
         }
     }
 
     if (board_under_check_mate_part(&G->board, &G->board.wking))
     {
         G->checkmate = cpWTURN;
-        game_io_printf("IT'S CHECKMATE PAL!\n");
+        game_io_printf(&G->io, "IT'S CHECKMATE PAL!\n");
     }
     else if (board_under_check_mate_part(&G->board, &G->board.bking))
     {
         G->checkmate = cpBTURN;
-        game_io_printf("IT'S CHECKMATE PAL!\n");
+        game_io_printf(&G->io, "IT'S CHECKMATE PAL!\n");
     }
     else
     {
@@ -642,11 +1504,12 @@ static void game_refresh(game_p G)
 
     if (G->checkmate == cpEEMPTY)
         game_io_printf(
+            &G->io,
             "It is %s turn.\n", G->turn == cpWTURN ? "WHITE" : "BLACK"
         );
 
-    board_print(&G->board);
-    game_msg_flush(&G->message);
+    board_print(&G->board, G->io.out);
+    game_msg_flush(&G->cold->message);
 }
 
 static void game_comm_eq_assert(game_p G)
@@ -657,12 +1520,12 @@ static void game_comm_eq_assert(game_p G)
 
     A.turn = G->turn;
 
-    /* C->comm_buf + 7 = G->comm_buf + len of "=assert" */
-    game_assert_parse(&A, G->comm_buf + 7, err, sizeof(err));
+    /* C->comm_buf + 7 = G->cold->comm_buf + len of "=assert" */
+    game_assert_parse(&A, G->cold->comm_buf + 7, err, sizeof(err));
 
     if (A.kind == ASSERT_KIND_UNKNOWN)
     {
-        game_msg_append(&G->message, err);
+        game_msg_append(&G->cold->message, err);
         G->done = GAME_DONE_ASSERT_PARSE;
         return;
     }
@@ -674,6 +1537,27 @@ static void game_comm_eq_assert(game_p G)
     }
 }
 
+static void game_comm_eq_fen(game_p G)
+{
+    const char* err;
+
+    /* The analysis is of the board being replaced */
+    game_analysis_stop(G);
+    G->cold->analysis.ponder = 0;
+
+    /* G->cold->comm_buf + 4 = G->cold->comm_buf + len of "=fen" */
+    err = board_from_fen(&G->board, &G->turn, G->cold->comm_buf + 4, NULL);
+    if (err != NULL)
+    {
+        game_msg_vappend(&G->cold->message, err, "\n", NULL);
+        return;
+    }
+
+    /* A new position: whatever ended the previous one is gone */
+    G->checkmate  = cpEEMPTY;
+    G->pawn_morph = cpEEMPTY;
+}
+
 static void game_comm_dot_noclear(game_p G)
 {
     if (game_has_flag(G, GOPT_CLEAR))
@@ -684,7 +1568,7 @@ static void game_comm_dot_noclear(game_p G)
 
 static void game_comm_dot_comment(game_p G)
 {
-    game_msg_append(&G->message, G->comm_buf + 2);
+    game_msg_append(&G->cold->message, G->cold->comm_buf + 2);
 }
 
 static void game_comm_dot_load(game_p G)
@@ -694,23 +1578,24 @@ static void game_comm_dot_load(game_p G)
     size_t      spc;
     FILE*       fp;
 
-    for (spc = 0; G->comm_buf[spc] && G->comm_buf[spc] != ' '; ++spc)
+    for (spc = 0; G->cold->comm_buf[spc] && G->cold->comm_buf[spc] != ' ';
+         ++spc)
         ;
 
-    fpath = G->comm_buf + spc + 1;
+    fpath = G->cold->comm_buf + spc + 1;
 
     fp    = fopen(fpath, "r");
     if (fp == NULL)
     {
         strerror_r(errno, fserr, sizeof(fserr));
         game_msg_vappend(
-            &G->message, "ERROR! COULD NOT LOAD! ", fserr, "\n", NULL
+            &G->cold->message, "ERROR! COULD NOT LOAD! ", fserr, "\n", NULL
         );
         return;
     }
 
-    game_init(G, G->opts);
-    game_io_set_stream_in(fp);
+    game_reset(G);
+    game_io_load(&G->io, fp);
     game_set_flag(G, GOPT_IN_LOAD);
 }
 
@@ -723,38 +1608,53 @@ static int game_has_flag(game_p G, int flag) { return G->opts & flag; }
 static void game_comm_dot_norecord(game_p G)
 {
     game_unset_flag(G, GOPT_REC);
-    game_msg_append(&G->message, "Record is disabled");
+    game_msg_append(&G->cold->message, "Record is disabled");
 }
 
 static void game_comm_dot_record(game_p G)
 {
     game_set_flag(G, GOPT_REC);
-    game_msg_append(&G->message, "Record is enabled");
-    history_println(G->comm_buf);
+    game_msg_append(&G->cold->message, "Record is enabled");
+    history_println(&G->history, G->cold->comm_buf);
 }
 
 #ifdef DEBUG
 void game_meminfo(void)
 {
-    struct game_t T;
+    struct game_t      T;
+    struct game_cold_t C;
 
     printf("struct game_t: %lu\n", sizeof(T));
-    printf(" message:      %lu\n", sizeof(T.message));
-    printf(" comm_buf:     %lu\n", sizeof(T.comm_buf));
     printf(" board:        %lu\n", sizeof(T.board));
-    printf(" comm_type:    %lu\n", sizeof(T.comm_type));
     printf(" comm_move:    %lu\n", sizeof(T.comm_move));
-    printf(" done:         %lu\n", sizeof(T.done));
+    printf(" comm_type:    %lu\n", sizeof(T.comm_type));
     printf(" opts:         %lu\n", sizeof(T.opts));
     printf(" turn:         %lu\n", sizeof(T.turn));
     printf(" checkmate:    %lu\n", sizeof(T.checkmate));
     printf(" pawn_morph:   %lu\n", sizeof(T.pawn_morph));
+    printf(" done:         %lu\n", sizeof(T.done));
+    printf(" cold:         %lu\n", sizeof(T.cold));
+    printf(" pool:         %lu\n", sizeof(T.pool));
+    printf(" io:           %lu\n", sizeof(T.io));
+    printf(" history:      %lu\n", sizeof(T.history));
     printf(
         " ------------- %lu\n",
-        sizeof(T.message) + sizeof(T.board) + sizeof(T.comm_buf) +
-            sizeof(T.done) + sizeof(T.turn) + sizeof(T.comm_type) +
-            sizeof(T.comm_move) + sizeof(T.checkmate) + sizeof(T.opts) +
-            sizeof(T.pawn_morph)
+        sizeof(T.board) + sizeof(T.comm_move) + sizeof(T.comm_type) +
+            sizeof(T.opts) + sizeof(T.turn) + sizeof(T.checkmate) +
+            sizeof(T.pawn_morph) + sizeof(T.done) + sizeof(T.cold) +
+            sizeof(T.pool) + sizeof(T.io) + sizeof(T.history)
+    );
+
+    printf("\nstruct game_cold_t: %lu\n", sizeof(C));
+    printf(" message:           %lu\n", sizeof(C.message));
+    printf(" comm_buf:          %lu\n", sizeof(C.comm_buf));
+    printf(" book:              %lu\n", sizeof(C.book));
+    printf(" explore:           %lu\n", sizeof(C.explore));
+    printf(" analysis:          %lu\n", sizeof(C.analysis));
+    printf(
+        " ------------------ %lu\n",
+        sizeof(C.message) + sizeof(C.comm_buf) + sizeof(C.book) +
+            sizeof(C.explore) + sizeof(C.analysis)
     );
 }
 #endif
@@ -4,8 +4,16 @@
 #ifndef CMC_CHESS_GAME_H
 #define CMC_CHESS_GAME_H
 
+#include <pthread.h>
+
 #include "board.h"
+#include "book.h"
+#include "explore.h"
+#include "game_history.h"
+#include "game_io.h"
 #include "game_msg.h"
+#include "pool.h"
+#include "search.h"
 
 #ifdef __AVR__
 #define GAME_COMMAND_LENGTH 64
@@ -21,7 +29,9 @@ enum
     /* Dot Command */
     GD_NEW,
     GD_DUMP,
+    GD_DUMP_APPEND,
     GD_RESTORE,
+    GD_RESTORE_AT,
     GD_NOCLEAR,
     GD_SAVE,
     GD_SAVE_FORCE,
@@ -29,14 +39,30 @@ enum
     GD_LOAD,
     GD_NO_RECORD,
     GD_RECORD,
+    GD_BOOK,
+    GD_BOOK_MOVE,
+    GD_EXPLORE,
+    GD_TBGEN,
+    GD_TBMOVE,
+    GD_TBSAVE,
+    GD_TBLOAD,
+    GD_ANALYZE,
+    GD_STOP,
+    GD_PONDER,
 
     /* Question Mark Command */
     GQ_LIST,
+    GQ_FEN,
+    GQ_BOOK,
+    GQ_EXPLORE,
+    GQ_DTM,
+    GQ_KPK,
 
     /* Equal Command */
     GE_CLEAR,
     GE_SET,
     GE_ASSERT,
+    GE_FEN,
 
     /* Play */
     GP_MOVE
@@ -47,37 +73,92 @@ enum
     GOPT_CLEAR   = 0x1, /* Set: clear afet each command; Or: do not clear */
     GOPT_IN_LOAD = 0x2, /* Set: load in progress; Or: load not in progress */
     GOPT_REC     = 0x4, /* Set: store for all command; Or: no store at all */
+    GOPT_REMOTE  = 0x8, /* Set: server session (see server.h); Or: REPL */
 
     ___cmc_chess_game_h_gopt_sentinel
 };
 
-typedef struct game_t
+/* Background analysis (see .analyze): the search runs on its own thread
+ * and on its own copy of the board, while commands keep being read; it
+ * reports to search.ctx, the streams of the game */
+typedef struct game_analysis_t
+{
+    struct search_t search;
+    struct board_t  board;
+    turn_t          turn;
+    pthread_t       thread;
+    int             running;  /* thread is to be joined */
+    int             finished; /* Set by the thread when the search is over */
+    int             ponder;   /* Analyse again after every move */
+}* game_analysis_p;
+
+/* Rarely touched state of a game: held from the first command on, given
+ * back by game_idle while nothing needs it */
+typedef struct game_cold_t
 {
     struct game_msg_t message;
     char              comm_buf[GAME_COMMAND_LENGTH];
-    struct board_t    board;
 
-    int           comm_type;
-    struct move_t comm_move;
+    struct book_t    book;    /* Not mapped if book.base is NULL */
+    struct explore_t explore; /* Not mapped if explore.base is NULL */
 
-    const char* done;
+    struct game_analysis_t analysis;
+}* game_cold_p;
 
-    int opts;
+typedef struct game_t
+{
+    struct board_t board;
+    struct move_t  comm_move;
+    int            comm_type;
+    int            opts;
 
     turn_t turn;
     turn_t checkmate;
 
     piece_t pawn_morph;
+
+    const char* done;
+
+    game_cold_p cold; /* NULL while idle */
+    pool_p      pool; /* Of cold (see game_pool_init); NULL: malloc */
+
+    struct game_io_t io; /* stdin and stdout after game_init */
+    struct history_t history;
 }* game_p;
 
 extern const char* GAME_DONE_COULD_NOT_READ_STDIN;
 extern const char* GAME_DONE_COMM_QUIT;
 extern const char* GAME_DONE_ASSERT_FAILED;
 extern const char* GAME_DONE_ASSERT_PARSE;
+extern const char* GAME_DONE_NO_MEMORY;
 
+/* G->pool is NULL: set it after game_init to share a pool among games */
 extern void game_init(game_p G, int flags);
+
+/* Pool of the cold state of games */
+extern void game_pool_init(pool_p P);
+
+/* Read commands from G->io.in until the game is done */
 extern void game_run(game_p);
 
+/* Drive a game one command at a time instead of game_run: game_start prints
+ * the board and the first prompt, game_input runs the command line (trailing
+ * newline optional) and prints what follows, until G->done is set; then (or
+ * to drop the game earlier) game_end stops what runs in the background and
+ * releases files, maps and G->cold (G->io.in and G->io.out are the
+ * caller's).
+ *
+ * Between two commands, game_idle gives G->cold back if nothing needs it
+ * (no analysis, book, index nor .load in progress).
+ *
+ * RETURN (game_idle)
+ * 1 if G holds no cold state.
+ */
+extern void game_start(game_p G);
+extern void game_input(game_p G, const char* line);
+extern int  game_idle(game_p G);
+extern void game_end(game_p G);
+
 #ifdef DEBUG
 extern void game_meminfo(void);
 #endif
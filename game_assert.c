@@ -65,9 +65,9 @@ void game_assert_parse(
     char attr_name[MAX_ATTR_NAME_LENGTH];
     int  tmp; /* For piece and turn */
 
-    A->src.row    = -1;
-    A->dst.row    = -1;
-    A->whence.row = -1;
+    A->src.row    = A->src.col = -1;
+    A->dst.row    = A->dst.col = -1;
+    A->whence.row = A->whence.col = -1;
     A->pawn_morph = cpEEMPTY;
 
     A->rev        = 0;
@@ -7,50 +7,34 @@
 
 #include <errno.h>
 #include <fcntl.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
-static int         fd             = -1;
-static const char* fname_template = "/tmp/cmc-chess-XXXXXX";
-static char        fname[32];
+static const char fname_template[] = "/tmp/cmc-chess-XXXXXX";
 
-void history_init(void)
-{
-    if (fd == -1)
-    {
-        memcpy(fname, fname_template, sizeof(fname));
-        fd = mkstemp(fname);
-    }
-    else
-    {
-        close(fd);
-        fd = creat(fname, 0600);
-    }
+static int history_open(history_p H);
 
-    if (fd == -1)
-    {
-        fprintf(stderr, "Cannot stat temp file.\n");
-        exit(1);
-    }
-}
+void history_init(history_p H) { H->fd = -1; }
 
-int history_println(char* str)
+int history_println(history_p H, char* str)
 {
     size_t  toadd = 0;
     size_t  len;
     ssize_t res;
 
+    if (H->fd == -1 && !history_open(H))
+        return 0;
+
     len = strlen(str);
 
-    if (str[len - 1] != '\n')
+    if (len == 0 || str[len - 1] != '\n')
     {
         str[len] = '\n';
         toadd    = 1;
     }
 
-    res = write(fd, str, len + toadd);
+    res = write(H->fd, str, len + toadd);
 
     if (toadd == 1)
         str[len] = '\0';
@@ -58,11 +42,12 @@ int history_println(char* str)
     return res != -1;
 }
 
-int history_mv(const char* fname_to)
+int history_mv(history_p H, const char* fname_to)
 {
     int fddst;
+    int ok;
 
-    if (fd < 0)
+    if (H->fd < 0)
     {
         errno = ENOENT;
         return 0;
@@ -72,17 +57,32 @@ int history_mv(const char* fname_to)
     if (fddst == -1)
         return 0;
 
-    if (file_copy(fd, fddst))
-        return 1;
+    ok = file_copy(H->fd, fddst);
 
-    return close(fddst) != -1;
+    return close(fddst) != -1 && ok;
 }
 
-void history_close(void)
+void history_close(history_p H)
 {
-    if (fd < 0)
+    if (H->fd < 0)
         return;
 
-    close(fd);
-    fd = -1;
+    close(H->fd);
+    H->fd = -1;
+}
+
+/* Created at the first line: games that record nothing cost no file */
+static int history_open(history_p H)
+{
+    char fname[sizeof(fname_template)];
+
+    memcpy(fname, fname_template, sizeof(fname));
+    H->fd = mkstemp(fname);
+    if (H->fd == -1)
+        return 0;
+
+    /* Only the descriptor is used: the file goes away with it */
+    unlink(fname);
+
+    return 1;
 }
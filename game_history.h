@@ -4,15 +4,22 @@
 #ifndef CMC_CHESS_HISTORY_H
 #define CMC_CHESS_HISTORY_H
 
-extern void history_init(void);
+/* Commands of a game, in a temporary file of its own */
+typedef struct history_t
+{
+    int fd; /* -1 until the first line */
+}* history_p;
+
+extern void history_init(history_p H);
 
 /* Prints a new line only if str does not end with '\n'; If it does, that is
- * considered as the desired new line. */
-extern int history_println(char* str);
+ * considered as the desired new line. str must have room for one more
+ * char. */
+extern int history_println(history_p H, char* str);
 
 /* If fname already exists, history_mv fails and errno is set to EEXIST */
-extern int history_mv(const char* fname);
+extern int history_mv(history_p H, const char* fname);
 
-extern void history_close(void);
+extern void history_close(history_p H);
 
 #endif /* CMC_CHESS_HISTORY_H */
@@ -2,45 +2,57 @@
 /* SPDX-License-Identifier: AGPL-3.0-only */
 
 #include "game_io.h"
-#include "exit_codes.h"
-#include "util.h"
 
 #include <stdarg.h>
 #include <stdio.h>
 
-static FILE* game_io_stream_in = NULL;
+void game_io_init(game_io_p IO, FILE* in, FILE* out)
+{
+    IO->in   = in;
+    IO->out  = out;
+    IO->load = NULL;
+}
 
-void game_io_init(void) { game_io_stream_in = stdin; }
+void game_io_close(game_io_p IO)
+{
+    if (IO->load != NULL)
+        fclose(IO->load);
 
-void game_io_printf(const char* fmt, ...)
+    IO->load = NULL;
+}
+
+void game_io_printf(game_io_p IO, const char* fmt, ...)
 {
     va_list args;
 
     va_start(args, fmt);
-    vprintf(fmt, args);
+    vfprintf(IO->out, fmt, args);
     va_end(args);
 }
 
-void game_io_putc(int ch) { fputc(ch, stdout); }
+void game_io_putc(game_io_p IO, int ch) { fputc(ch, IO->out); }
 
-void game_io_puts(const char* str) { fputs(str, stdout); }
+void game_io_puts(game_io_p IO, const char* str) { fputs(str, IO->out); }
 
-int game_io_gets(char* str, int str_length)
-{
-    assert_fatal(game_io_stream_in != NULL, CHESS_GAME_IO_NOT_INIT);
+void game_io_flush(game_io_p IO) { fflush(IO->out); }
 
-    str = fgets(str, str_length, game_io_stream_in);
+int game_io_gets(game_io_p IO, char* str, int str_length)
+{
+    if (IO->load != NULL)
+    {
+        if (fgets(str, str_length, IO->load) != NULL)
+            return 1;
 
-    if (game_io_stream_in != stdin && feof(game_io_stream_in))
-        game_io_stream_in = stdin; /* File terminated; back to stdin */
+        /* File terminated; back to in */
+        game_io_close(IO);
+        return 0;
+    }
 
-    return str != NULL;
+    return IO->in != NULL && fgets(str, str_length, IO->in) != NULL;
 }
 
-void game_io_set_stream_in(FILE* fp)
+void game_io_load(game_io_p IO, FILE* fp)
 {
-    if (fp != NULL)
-        game_io_stream_in = fp;
-    else
-        game_io_stream_in = stdin;
+    game_io_close(IO);
+    IO->load = fp;
 }
@@ -6,17 +6,34 @@
 
 #include <stdio.h>
 
+/* Streams of a game: every game has its own, games on different threads do
+ * not share anything but the streams they are given. */
+typedef struct game_io_t
+{
+    FILE* in;   /* Commands; NULL if they are given otherwise (game_input) */
+    FILE* out;  /* Board, prompts and messages */
+    FILE* load; /* File of .load, read before in until its end; or NULL */
+}* game_io_p;
+
 /* Control */
-extern void game_io_init(void);
-extern void game_io_set_stream_in(FILE* fp);
+extern void game_io_init(game_io_p IO, FILE* in, FILE* out);
+extern void game_io_close(game_io_p IO); /* Closes load, if any */
+
+/* Read fp (taking ownership of it) until its end, before in */
+extern void game_io_load(game_io_p IO, FILE* fp);
 
 /* Out */
-extern void game_io_printf(const char* fmt, ...)
-    __attribute__((format(printf, 1, 2)));
-extern void game_io_putc(int);
-extern void game_io_puts(const char*);
+extern void game_io_printf(game_io_p IO, const char* fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+extern void game_io_putc(game_io_p IO, int);
+extern void game_io_puts(game_io_p IO, const char*);
+extern void game_io_flush(game_io_p IO);
 
-/* In */
-extern int game_io_gets(char* str, int str_length);
+/* In.
+ *
+ * RETURN
+ * 0 at the end of load (once) or of in.
+ */
+extern int game_io_gets(game_io_p IO, char* str, int str_length);
 
 #endif /* CMC_CHESS_GAME_IO_H */
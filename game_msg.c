@@ -19,8 +19,7 @@ void game_msg_append(game_msg_p E, const char* str)
     else
         --E->cur; /* Next time \0 will be overwritten */
 #elif GAME_MSG_BUFFER_TYPE == GAME_MSG_BUFFER_NONE
-    (void)E;
-    game_io_puts(str);
+    game_io_puts(E->io, str);
 #else
 #error "GAME_MSG_BUFFER_TYPE has got an illegal value"
 #endif
@@ -29,7 +28,7 @@ void game_msg_append(game_msg_p E, const char* str)
 void game_msg_flush(game_msg_p E)
 {
 #if GAME_MSG_BUFFER_TYPE == GAME_MSG_BUFFER_TOTAL
-    game_io_puts(E->buf);
+    game_io_puts(E->io, E->buf);
     game_msg_clear(E);
 #elif GAME_MSG_BUFFER_TYPE == GAME_MSG_BUFFER_NONE
     (void)E;
@@ -62,7 +61,11 @@ void game_msg_vappend(game_msg_p E, ...)
     va_end(args);
 }
 
-void game_msg_init(game_msg_p E) { game_msg_clear(E); }
+void game_msg_init(game_msg_p E, game_io_p IO)
+{
+    E->io = IO;
+    game_msg_clear(E);
+}
 
 #ifdef DEBUG
 void game_msg_meminfo(void)
@@ -73,10 +76,13 @@ void game_msg_meminfo(void)
 #if GAME_MSG_BUFFER_TYPE == GAME_MSG_BUFFER_TOTAL
     printf(" buf:              %lu\n", sizeof(T.buf));
     printf(" cur:              %lu\n", sizeof(T.cur));
-    printf(" ----------------- %lu\n", sizeof(T.buf) + sizeof(T.cur));
+    printf(" io:               %lu\n", sizeof(T.io));
+    printf(
+        " ----------------- %lu\n", sizeof(T.buf) + sizeof(T.cur) + sizeof(T.io)
+    );
 #elif GAME_MSG_BUFFER_TYPE == GAME_MSG_BUFFER_NONE
-    printf(" nobuf:            %lu\n", sizeof(T.nobuf));
-    printf(" ----------------- %lu\n", sizeof(T.nobuf));
+    printf(" io:               %lu\n", sizeof(T.io));
+    printf(" ----------------- %lu\n", sizeof(T.io));
 #else
 #error "GAME_MSG_BUFFER_TYPE has got an illegal value"
 #endif
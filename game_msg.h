@@ -4,6 +4,8 @@
 #ifndef CMC_CHESS_GAME_MSG_H
 #define CMC_CHESS_GAME_MSG_H
 
+#include "game_io.h"
+
 #ifdef __AVR__
 #define GAME_MSG_LENGTH 120
 #else
@@ -23,13 +25,14 @@ typedef struct game_msg_t
     char  buf[GAME_MSG_LENGTH];
     char* cur; /* Index of next writable char */
 #elif GAME_MSG_BUFFER_TYPE == GAME_MSG_BUFFER_NONE
-    char nobuf;
 #else
 #error "GAME_MSG_BUFFER_TYPE has got an illegal value"
 #endif
+
+    game_io_p io; /* Where messages are flushed */
 }* game_msg_p;
 
-extern void game_msg_init(game_msg_p E);
+extern void game_msg_init(game_msg_p E, game_io_p IO);
 extern void game_msg_append(game_msg_p E, const char* str);
 extern void game_msg_vappend(game_msg_p E, ...);
 extern void game_msg_flush(game_msg_p E);
@@ -16,6 +16,36 @@ typedef unsigned char myuint8_t;
 #error "No suitable 8 bit data type"
 #endif
 
+#if USHRT_MAX == 0xFFFF
+typedef unsigned short myuint16_t;
+#else
+#error "No suitable 16 bit data type"
+#endif
+
+#if UINT_MAX == 0xFFFFFFFF
+typedef unsigned int myuint32_t;
+#else
+#error "No suitable 32 bit data type"
+#endif
+
+/* C89 has no long long: unsigned long is used where it is 64 bit, GNU
+ * compilers where it is not (32 bit hosts) have unsigned long long as an
+ * extension. ULONG_MAX is shifted in two steps because shifting by 63 would
+ * be undefined where long is 32 bit.
+ *
+ * The board is made of 64 bit masks: there is no build without the type.
+ * Constants that do not fit 32 bits are written through MYUINT64_C, as a UL
+ * constant would be too large where long is 32 bit */
+#if (ULONG_MAX >> 31 >> 31) == 3
+typedef unsigned long myuint64_t;
+#define MYUINT64_C(c) c##UL
+#elif defined(__GNUC__)
+__extension__ typedef unsigned long long myuint64_t;
+#define MYUINT64_C(c) (__extension__ c##ULL)
+#else
+#error "No suitable 64 bit data type"
+#endif
+
 #endif
 
 #endif /* CMC_CHESS_INT_H */
@@ -0,0 +1,50 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#include <stddef.h>
+
+#include "attack.h"
+#include "kpk.h"
+
+int kpk_probe(board_p B, turn_t turn)
+{
+    myuint64_t pawns;
+    size_t     idx;
+    int        pawn;
+    int        wking;
+    int        bking;
+    int        mirror;
+
+    pawns = board_mask(B, cpWPAWN) | board_mask(B, cpBPAWN);
+    if (pawns == 0)
+        return 0;
+
+    /* Pawns never stand on the first or the last row */
+    pawn = attack_first(pawns);
+    if (pawn < 8 || pawn >= 56)
+        return 0;
+
+    if (board_at(B, pawn) == cpWPAWN)
+    {
+        wking = 8 * B->wking.row + B->wking.col;
+        bking = 8 * B->bking.row + B->bking.col;
+    }
+    else
+    {
+        /* Swap colours: ranks are flipped */
+        pawn  = 8 * (7 - pawn / 8) + pawn % 8;
+        wking = 8 * (7 - B->bking.row) + B->bking.col;
+        bking = 8 * (7 - B->wking.row) + B->wking.col;
+        turn  = (turn_t)~turn;
+    }
+
+    /* sq ^ 7 mirrors the column of sq */
+    mirror = wking % 8 > 3 ? 7 : 0;
+
+    idx    = (size_t)(turn == cpWTURN ? 0 : 32);
+    idx += (size_t)(wking / 8 * 4 + (wking % 8 ^ mirror));
+    idx = (idx * 48 + (size_t)(pawn ^ mirror) - 8) * 64;
+    idx += (size_t)(bking ^ mirror);
+
+    return kpk_table[idx / 8] >> (idx % 8) & 1;
+}
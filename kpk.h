@@ -0,0 +1,37 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_KPK_H
+#define CMC_CHESS_KPK_H
+
+#include "board.h"
+#include "int.h"
+#include "piece.h"
+
+/* King and pawn versus king bitbase.
+ *
+ * One bit per position, set if the side with the pawn wins (the lone king
+ * can at best draw). Positions are seen with the pawn white and the white
+ * king on files a-d (the board is mirrored otherwise); bit i of the table is
+ * bit i % 8 of byte i / 8, with
+ *
+ *   i = ((turn * 32 + wking) * 48 + pawn - 8) * 64 + bking
+ *
+ * where turn is 0 if white is to move, wking is 4 * row + col, pawn and
+ * bking are 8 * row + col. Invalid positions are draws.
+ *
+ * The table is generated at build time by tools/kpk_gen.c from the KPvK
+ * tablebase (see tb.h), hence with the move semantics of board.c.
+ */
+#define KPK_POSITIONS (2 * 32 * 48 * 64)
+
+extern const myuint8_t kpk_table[KPK_POSITIONS / 8];
+
+/* B must hold the two kings and a single pawn, of either colour.
+ *
+ * RETURN
+ * 1 if the side with the pawn wins, 0 if it is a draw.
+ */
+extern int kpk_probe(board_p B, turn_t turn);
+
+#endif /* CMC_CHESS_KPK_H */
@@ -2,26 +2,75 @@
 /* SPDX-License-Identifier: AGPL-3.0-only */
 
 #include <stdio.h>
+#include <stdlib.h>
 
+#include "bench.h"
 #include "board.h"
+#include "board_archive.h"
 #include "coord.h"
+#include "epd.h"
+#include "explore.h"
 #include "exit_codes.h"
 #include "game.h"
+#include "game_assert.h"
 #include "game_msg.h"
+#include "pgn.h"
+#include "server.h"
+#include "tb.h"
+#include "uci.h"
 #include "util.h"
 
+/* State shared by main_assert_archive and main_assert_archive_visit */
+struct main_assert_archive_t
+{
+    const char* assertion;
+    size_t      failed;
+    int         parse_failed;
+};
+
 #ifdef DEBUG
 static void meminfo(void);
 #endif
 
+static int main_assert_archive(int argc, char** argv);
+static int main_dedup_archive(int argc, char** argv);
+static int main_epd_perft(int argc, char** argv);
+static int main_pgn_check(int argc, char** argv);
+static int main_build_index(int argc, char** argv);
+static int main_build_tb(int argc, char** argv);
+static int main_serve(int argc, char** argv);
+static int main_bench(int argc, char** argv);
+static int
+main_assert_archive_visit(void* ctx, size_t i, board_p B, turn_t turn);
+
 /* Argv:
  * - 0: program name or path;
- * - 1: [meminfo]:
- *   - meminfo (ifdef DEBUG): print structs sizes.
+ * - 1: [meminfo|assert-archive|dedup-archive|epd-perft|pgn-check|build-index|
+ *       build-tb|uci|serve|bench]:
+ *   - meminfo (ifdef DEBUG): print structs sizes;
+ *   - assert-archive FILE ASSERTION: check ASSERTION (same syntax as
+ *     =assert) against every position stored in the dump FILE;
+ *   - dedup-archive FILE OUT: write the positions of the dump FILE to the
+ *     dump OUT, each one once (see board_archive.h);
+ *   - epd-perft FILE [THREADS [MAX_DEPTH]]: run the perft suite in the EPD
+ *     FILE (see epd.h). THREADS defaults to 0 (one per CPU);
+ *   - pgn-check FILE [THREADS]: report the first illegal move of every game
+ *     in the PGN FILE (see pgn.h);
+ *   - build-index INDEX PGN [THREADS]: build the opening explorer INDEX from
+ *     the games in PGN (see explore.h);
+ *   - build-tb SIG FILE [THREADS]: generate the endgame table SIG and save
+ *     it to FILE (see tb.h);
+ *   - uci: speak UCI on stdin/stdout instead of running the game (see
+ *     uci.h);
+ *   - serve SOCKET [THREADS]: serve one game per connection on the Unix
+ *     domain SOCKET (see server.h);
+ *   - bench [ROUNDS]: time fixed workloads on the board backend of the
+ *     build, best of ROUNDS runs (3 by default, see bench.h).
  */
 int main(int argc, char** argv)
 {
     struct game_t game;
+    int           ret;
 
     if (argc > 1)
     {
@@ -35,6 +84,42 @@ int main(int argc, char** argv)
             return CHESS_COMMAND_NA_DEBUG_UNDEF;
 #endif
         }
+        else if (streq_ci(argv[1], "assert-archive"))
+        {
+            return main_assert_archive(argc, argv);
+        }
+        else if (streq_ci(argv[1], "dedup-archive"))
+        {
+            return main_dedup_archive(argc, argv);
+        }
+        else if (streq_ci(argv[1], "epd-perft"))
+        {
+            return main_epd_perft(argc, argv);
+        }
+        else if (streq_ci(argv[1], "pgn-check"))
+        {
+            return main_pgn_check(argc, argv);
+        }
+        else if (streq_ci(argv[1], "build-index"))
+        {
+            return main_build_index(argc, argv);
+        }
+        else if (streq_ci(argv[1], "build-tb"))
+        {
+            return main_build_tb(argc, argv);
+        }
+        else if (streq_ci(argv[1], "uci"))
+        {
+            return uci_run();
+        }
+        else if (streq_ci(argv[1], "serve"))
+        {
+            return main_serve(argc, argv);
+        }
+        else if (streq_ci(argv[1], "bench"))
+        {
+            return main_bench(argc, argv);
+        }
         else
         {
             fprintf(stderr, "`%s`: not valid command.\n", argv[1]);
@@ -48,26 +133,316 @@ int main(int argc, char** argv)
     if (game.done == GAME_DONE_COMM_QUIT)
     {
         printf("Bye\n");
+        ret = CHESS_OK;
     }
     else if (game.done == GAME_DONE_ASSERT_FAILED)
     {
-        fprintf(stderr, "Error: %s.\n%s\n", game.done, game.comm_buf);
-        return CHESS_ASSERT_FAILED;
+        fprintf(stderr, "Error: %s.\n%s\n", game.done, game.cold->comm_buf);
+        ret = CHESS_ASSERT_FAILED;
     }
     else if (game.done == GAME_DONE_ASSERT_PARSE)
     {
         fprintf(stderr, "Error: %s.\n", game.done);
-        return CHESS_ASSERT_PARSE_FAILED;
+        ret = CHESS_ASSERT_PARSE_FAILED;
     }
     else
     {
         fprintf(stderr, "Error: %s.\n", game.done);
-        return CHESS_GAME_ERROR;
+        ret = CHESS_GAME_ERROR;
+    }
+
+    game_end(&game);
+
+    return ret;
+}
+
+static int main_assert_archive(int argc, char** argv)
+{
+    struct board_archive_t       A;
+    struct main_assert_archive_t X;
+    const char*                  err;
+    size_t                       count;
+
+    if (argc != 4)
+    {
+        fprintf(stderr, "Usage: %s assert-archive FILE ASSERTION\n", argv[0]);
+        return CHESS_COMMAND_BAD_ARGS;
+    }
+
+    err = board_archive_open(&A, argv[2]);
+    if (err != NULL)
+    {
+        fprintf(stderr, "Error: %s: %s.\n", argv[2], err);
+        return CHESS_ARCHIVE_ERROR;
+    }
+
+    X.assertion    = argv[3];
+    X.failed       = 0;
+    X.parse_failed = 0;
+
+    count          = A.count;
+    err            = board_archive_foreach(&A, main_assert_archive_visit, &X);
+    board_archive_close(&A);
+
+    if (err != NULL)
+    {
+        fprintf(stderr, "Error: %s: %s.\n", argv[2], err);
+        return CHESS_ARCHIVE_ERROR;
+    }
+
+    if (X.parse_failed)
+        return CHESS_ASSERT_PARSE_FAILED;
+
+    printf(
+        "%lu positions, %lu failed\n",
+        (unsigned long)count,
+        (unsigned long)X.failed
+    );
+
+    return X.failed == 0 ? CHESS_OK : CHESS_ASSERT_FAILED;
+}
+
+static int
+main_assert_archive_visit(void* ctx, size_t i, board_p B, turn_t turn)
+{
+    struct main_assert_archive_t* X = ctx;
+    struct game_assert_t          A;
+    char                          err[256];
+    int                           positive_result;
+
+    /* Like =assert: the turn is the one of the position, unless specified */
+    A.turn = turn;
+    game_assert_parse(&A, X->assertion, err, sizeof(err));
+
+    if (A.kind == ASSERT_KIND_UNKNOWN)
+    {
+        fprintf(stderr, "Error: %s.\n", err);
+        X->parse_failed = 1;
+        return 1;
+    }
+
+    positive_result = board_assert(B, &A);
+    if ((A.rev && positive_result) || (!A.rev && !positive_result))
+    {
+        printf("%lu: assert failed\n", (unsigned long)i);
+        ++X->failed;
+    }
+
+    return 0;
+}
+
+static int main_dedup_archive(int argc, char** argv)
+{
+    struct board_archive_t A;
+    const char*            err;
+    size_t                 kept;
+
+    if (argc != 4)
+    {
+        fprintf(stderr, "Usage: %s dedup-archive FILE OUT\n", argv[0]);
+        return CHESS_COMMAND_BAD_ARGS;
+    }
+
+    err = board_archive_open(&A, argv[2]);
+    if (err != NULL)
+    {
+        fprintf(stderr, "Error: %s: %s.\n", argv[2], err);
+        return CHESS_ARCHIVE_ERROR;
+    }
+
+    err = board_archive_dedup(&A, argv[3], &kept);
+    if (err == NULL)
+        printf(
+            "%lu positions, %lu unique\n",
+            (unsigned long)A.count,
+            (unsigned long)kept
+        );
+
+    board_archive_close(&A);
+
+    if (err != NULL)
+    {
+        fprintf(stderr, "Error: %s: %s.\n", argv[3], err);
+        return CHESS_ARCHIVE_ERROR;
     }
 
     return CHESS_OK;
 }
 
+static int main_epd_perft(int argc, char** argv)
+{
+    unsigned long nthreads  = 0;
+    unsigned long max_depth = 64;
+    char*         end       = NULL;
+
+    if (argc < 3 || argc > 5)
+    {
+        fprintf(
+            stderr, "Usage: %s epd-perft FILE [THREADS [MAX_DEPTH]]\n", argv[0]
+        );
+        return CHESS_COMMAND_BAD_ARGS;
+    }
+
+    if (argc > 3)
+    {
+        nthreads = strtoul(argv[3], &end, 10);
+        if (*argv[3] == '\0' || *end != '\0' || nthreads > 1024)
+        {
+            fprintf(stderr, "Error: `%s`: not a thread count.\n", argv[3]);
+            return CHESS_COMMAND_BAD_ARGS;
+        }
+    }
+
+    if (argc > 4)
+    {
+        max_depth = strtoul(argv[4], &end, 10);
+        if (*argv[4] == '\0' || *end != '\0' || max_depth > 64)
+        {
+            fprintf(stderr, "Error: `%s`: not a valid depth.\n", argv[4]);
+            return CHESS_COMMAND_BAD_ARGS;
+        }
+    }
+
+    return epd_perft(argv[2], (unsigned int)nthreads, (unsigned int)max_depth);
+}
+
+static int main_pgn_check(int argc, char** argv)
+{
+    unsigned long nthreads = 0;
+    char*         end      = NULL;
+
+    if (argc < 3 || argc > 4)
+    {
+        fprintf(stderr, "Usage: %s pgn-check FILE [THREADS]\n", argv[0]);
+        return CHESS_COMMAND_BAD_ARGS;
+    }
+
+    if (argc > 3)
+    {
+        nthreads = strtoul(argv[3], &end, 10);
+        if (*argv[3] == '\0' || *end != '\0' || nthreads > 1024)
+        {
+            fprintf(stderr, "Error: `%s`: not a thread count.\n", argv[3]);
+            return CHESS_COMMAND_BAD_ARGS;
+        }
+    }
+
+    return pgn_check(argv[2], (unsigned int)nthreads);
+}
+
+static int main_build_index(int argc, char** argv)
+{
+    unsigned long nthreads = 0;
+    char*         end      = NULL;
+
+    if (argc < 4 || argc > 5)
+    {
+        fprintf(
+            stderr, "Usage: %s build-index INDEX PGN [THREADS]\n", argv[0]
+        );
+        return CHESS_COMMAND_BAD_ARGS;
+    }
+
+    if (argc > 4)
+    {
+        nthreads = strtoul(argv[4], &end, 10);
+        if (*argv[4] == '\0' || *end != '\0' || nthreads > 1024)
+        {
+            fprintf(stderr, "Error: `%s`: not a thread count.\n", argv[4]);
+            return CHESS_COMMAND_BAD_ARGS;
+        }
+    }
+
+    return explore_build(argv[2], argv[3], (unsigned int)nthreads);
+}
+
+static int main_build_tb(int argc, char** argv)
+{
+    unsigned long nthreads = 0;
+    char*         end      = NULL;
+    const char*   err;
+
+    if (argc < 4 || argc > 5)
+    {
+        fprintf(stderr, "Usage: %s build-tb SIG FILE [THREADS]\n", argv[0]);
+        return CHESS_COMMAND_BAD_ARGS;
+    }
+
+    if (argc > 4)
+    {
+        nthreads = strtoul(argv[4], &end, 10);
+        if (*argv[4] == '\0' || *end != '\0' || nthreads > 1024)
+        {
+            fprintf(stderr, "Error: `%s`: not a thread count.\n", argv[4]);
+            return CHESS_COMMAND_BAD_ARGS;
+        }
+    }
+
+    err = tb_generate(argv[2], (unsigned int)nthreads);
+    if (err != NULL)
+    {
+        fprintf(stderr, "Error: `%s`: %s.\n", argv[2], err);
+        return CHESS_COMMAND_BAD_ARGS;
+    }
+
+    err = tb_save(argv[2], argv[3]);
+    if (err != NULL)
+    {
+        fprintf(stderr, "Error: `%s`: %s.\n", argv[3], err);
+        return CHESS_FILE_ERROR;
+    }
+
+    return CHESS_OK;
+}
+
+static int main_serve(int argc, char** argv)
+{
+    unsigned long nthreads = 0;
+    char*         end      = NULL;
+
+    if (argc < 3 || argc > 4)
+    {
+        fprintf(stderr, "Usage: %s serve SOCKET [THREADS]\n", argv[0]);
+        return CHESS_COMMAND_BAD_ARGS;
+    }
+
+    if (argc > 3)
+    {
+        nthreads = strtoul(argv[3], &end, 10);
+        if (*argv[3] == '\0' || *end != '\0' || nthreads > 1024)
+        {
+            fprintf(stderr, "Error: `%s`: not a thread count.\n", argv[3]);
+            return CHESS_COMMAND_BAD_ARGS;
+        }
+    }
+
+    return server_run(argv[2], (unsigned int)nthreads);
+}
+
+static int main_bench(int argc, char** argv)
+{
+    unsigned long rounds = 3;
+    char*         end    = NULL;
+
+    if (argc > 3)
+    {
+        fprintf(stderr, "Usage: %s bench [ROUNDS]\n", argv[0]);
+        return CHESS_COMMAND_BAD_ARGS;
+    }
+
+    if (argc > 2)
+    {
+        rounds = strtoul(argv[2], &end, 10);
+        if (*argv[2] == '\0' || *end != '\0' || rounds == 0 || rounds > 100)
+        {
+            fprintf(stderr, "Error: `%s`: not a round count.\n", argv[2]);
+            return CHESS_COMMAND_BAD_ARGS;
+        }
+    }
+
+    return bench_run((unsigned int)rounds);
+}
+
 #ifdef DEBUG
 static void meminfo(void)
 {
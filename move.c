@@ -4,9 +4,16 @@
 #include "move.h"
 #include "coord.h"
 #include "int.h"
+#include "piece.h"
 
 #include <stdio.h>
 
+const move16_t MOVE16_NONE    = 0;
+const move16_t MOVE16_CAPTURE = 0x8000;
+
+static int  move16_square(coord_p C);
+static void move16_coord(int sq, coord_p C);
+
 void move_set_offset(move_p M)
 {
     M->offset.row = (myint8_t)(M->dest.row - M->source.row);
@@ -46,6 +53,98 @@ void move_init(move_p M, const char* str, size_t n)
     move_set_offset(M);
 }
 
+move16_t move16_pack(move_p M, piece_t pawn_morph)
+{
+    int mph = pawn_morph < 0 ? -pawn_morph : pawn_morph;
+
+    return (myuint16_t)(move16_square(&M->source) |
+                        move16_square(&M->dest) << 6 | mph << 12);
+}
+
+void move16_unpack(move16_t m, turn_t turn, move_p M, piece_t* pawn_morph)
+{
+    move16_coord(move16_source(m), &M->source);
+    move16_coord(move16_dest(m), &M->dest);
+    move_set_offset(M);
+
+    *pawn_morph = move16_morph(m);
+    if (turn != cpWTURN)
+        *pawn_morph = (piece_t)-*pawn_morph;
+}
+
+int move16_source(move16_t m)
+{
+    return m & 63;
+}
+
+int move16_dest(move16_t m)
+{
+    return m >> 6 & 63;
+}
+
+piece_t move16_morph(move16_t m)
+{
+    return (piece_t)(m >> 12 & 7);
+}
+
+int move16_is_capture(move16_t m)
+{
+    return (m & MOVE16_CAPTURE) != 0;
+}
+
+move16_t move16_from_str(const char* str, size_t n)
+{
+    struct move_t M;
+    const char*   end = str + n;
+    piece_t       pawn_morph;
+
+    move_init(&M, str, n);
+
+    if (M.source.row < 0 || M.source.row > 7 || M.source.col < 0 ||
+        M.source.col > 7 || M.dest.row < 0 || M.dest.row > 7 ||
+        M.dest.col < 0 || M.dest.col > 7 ||
+        (M.offset.row == 0 && M.offset.col == 0))
+        return MOVE16_NONE;
+
+    /* As move_init does, to find the letter after the move */
+    while (*str == ' ')
+        ++str;
+
+    pawn_morph = cpEEMPTY;
+    if (str + 4 < end && str[4] != ' ')
+    {
+        pawn_morph = piece_from_char(str[4], cpWTURN);
+        if (pawn_morph == cpEEMPTY || pawn_morph == cpWPAWN ||
+            pawn_morph == cpWKING)
+            return MOVE16_NONE;
+    }
+
+    return move16_pack(&M, pawn_morph);
+}
+
+void move16_to_str(move16_t m, char* buf)
+{
+    int mph = move16_morph(m);
+
+    buf[0] = (char)('a' + move16_source(m) % 8);
+    buf[1] = (char)('8' - move16_source(m) / 8);
+    buf[2] = (char)('a' + move16_dest(m) % 8);
+    buf[3] = (char)('8' - move16_dest(m) / 8);
+    buf[4] = mph == cpEEMPTY ? '\0' : cpBLACKS[mph];
+    buf[5] = '\0';
+}
+
+static int move16_square(coord_p C)
+{
+    return 8 * C->row + C->col;
+}
+
+static void move16_coord(int sq, coord_p C)
+{
+    C->row = (myint8_t)(sq / 8);
+    C->col = (myint8_t)(sq % 8);
+}
+
 #ifdef DEBUG
 void move_meminfo(void)
 {
@@ -61,5 +160,6 @@ void move_meminfo(void)
         sizeof(T.source) + sizeof(T.dest) + sizeof(T.offset) +
             sizeof(T.abs_offset)
     );
+    printf("move16_t:      %lu\n", sizeof(move16_t));
 }
 #endif
@@ -7,6 +7,8 @@
 #include <stddef.h>
 
 #include "coord.h"
+#include "int.h"
+#include "piece.h"
 
 typedef struct move_t
 {
@@ -32,6 +34,49 @@ typedef struct move_t
 extern void move_init(move_p M, const char* str, size_t n);
 extern void move_set_offset(move_p M);
 
+/* Packed move:
+ * - bits 0-5:   source square (8 * row + col, as in struct board_t);
+ * - bits 6-11:  destination square;
+ * - bits 12-14: absolute value of the piece a pawn morphs into, cpEEMPTY
+ *               if none;
+ * - bit 15:     MOVE16_CAPTURE.
+ *
+ * Source and destination of a move differ: 0 (MOVE16_NONE) is no move.
+ */
+typedef myuint16_t move16_t;
+
+extern const move16_t MOVE16_NONE;
+
+/* Set by board_legal_moves on moves that take over a piece */
+extern const move16_t MOVE16_CAPTURE;
+
+/* Size of the buffer of move16_to_str */
+#define MOVE16_STR_SIZE 6
+
+/* No flags are set */
+extern move16_t move16_pack(move_p M, piece_t pawn_morph);
+
+/* pawn_morph is given the colour of turn */
+extern void
+move16_unpack(move16_t m, turn_t turn, move_p M, piece_t* pawn_morph);
+
+extern int     move16_source(move16_t m);
+extern int     move16_dest(move16_t m);
+extern piece_t move16_morph(move16_t m); /* Absolute */
+extern int     move16_is_capture(move16_t m);
+
+/* The text of move_init, optionally followed by the letter of the piece a
+ * pawn morphs into (as in "e7e8q").
+ *
+ * RETURN
+ * MOVE16_NONE if str is not a move.
+ */
+extern move16_t move16_from_str(const char* str, size_t n);
+
+/* Write m to buf (MOVE16_STR_SIZE chars) in the format of move16_from_str,
+ * lower case (as UCI wants it) */
+extern void move16_to_str(move16_t m, char* buf);
+
 #ifdef DEBUG
 extern void move_meminfo(void);
 #endif
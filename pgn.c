@@ -0,0 +1,667 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#define _POSIX_C_SOURCE 200809L
+#include <ctype.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "board.h"
+#include "exit_codes.h"
+#include "pgn.h"
+#include "util.h"
+#include "workq.h"
+
+const char* PGN_ERR_SAN           = "not a SAN move";
+const char* PGN_ERR_SAN_ILLEGAL   = "illegal move";
+const char* PGN_ERR_SAN_AMBIGUOUS = "ambiguous move";
+const char* PGN_ERR_FEN           = "FEN tag too long";
+const char* PGN_ERR_TAG           = "bad tag";
+
+/* Games waiting for a worker. Splitting is much faster than checking, so the
+ * queue is only meant to keep every worker busy */
+#define PGN_QUEUE_LENGTH 1024
+
+/* Longest FEN tag value, NUL terminator included */
+#define PGN_FEN_LENGTH 128
+
+/* State shared by the splitter and the workers of pgn_foreach */
+typedef struct pgn_run_t
+{
+    struct workq_t   queue;
+    pgn_game_visit_t visit;
+    void*            ctx;
+    unsigned int     workers; /* Started: the splitter visits if none */
+}* pgn_run_p;
+
+/* State of pgn_check, shared by its workers */
+typedef struct pgn_check_t
+{
+    pthread_mutex_t report_lock; /* Serializes output and totals */
+    unsigned long   games;
+    unsigned long   failed;
+    unsigned long   moves;
+}* pgn_check_p;
+
+static void  pgn_split(pgn_run_p R, const char* text, size_t size);
+static void  pgn_push(pgn_run_p R, pgn_game_p G);
+static void* pgn_worker(void* arg);
+static void  pgn_check_game(void* ctx, pgn_game_p G);
+
+/* Parse the tag pair at *cur (pointing to '['), moving *cur past it. The FEN
+ * tag sets B and turn, the Result tag sets *result.
+ *
+ * RETURN
+ * NULL on success, PGN_ERR_TAG, PGN_ERR_FEN or BOARD_FEN_ERR_* otherwise.
+ */
+static const char* pgn_tag(
+    board_p B, turn_t* turn, int* result, const char** cur, const char* end
+);
+
+/* Skip the variation at cur (pointing to '('), nested ones and comments
+ * included.
+ *
+ * RETURN
+ * A pointer past the variation.
+ */
+static const char* pgn_skip_variation(const char* cur, const char* end);
+
+/* RETURN
+ * PGN_RESULT_* if tok is a game termination marker, -1 otherwise.
+ */
+static int pgn_result(const char* tok, size_t n);
+
+/* RETURN
+ * PGN_RESULT_* if the last token of G is a game termination marker, -1
+ * otherwise.
+ */
+static int pgn_last_result(pgn_game_p G);
+
+const char* pgn_san_move(
+    board_p B, turn_t turn, const char* san, size_t n, move_p M,
+    piece_t* pawn_morph
+)
+{
+    struct move_t  candidate;
+    struct coord_t whence;
+    piece_t        piece;
+    piece_t        morph;
+    int            from_row = -1;
+    int            from_col = -1;
+    int            found    = 0;
+    int            capture  = 0;
+    size_t         i        = 0;
+
+    while (n > 0 && san[n - 1] != '\0' && strchr("+#!?", san[n - 1]) != NULL)
+        --n;
+
+    if (n >= 3 && (strncmp(san, "O-O", 3) == 0 || strncmp(san, "0-0", 3) == 0))
+        return ILLEGAL_MOVE_NOT_IMPLEMENTED_YET;
+
+    if (n > 0 && san[0] != '\0' && strchr("KQRBN", san[0]) != NULL)
+    {
+        piece = piece_from_char(san[0], turn);
+        i     = 1;
+    }
+    else
+    {
+        piece = piece_from_char('P', turn);
+    }
+
+    /* Promotion: "e8=Q" or "e8Q" */
+    morph = cpEEMPTY;
+    if ((piece == cpWPAWN || piece == cpBPAWN) && n > 2 &&
+        san[n - 1] != '\0' && strchr("QRBN", san[n - 1]) != NULL)
+    {
+        morph = piece_from_char(san[--n], turn);
+        if (san[n - 1] == '=')
+            --n;
+    }
+
+    if (n < i + 2)
+        return PGN_ERR_SAN;
+
+    if (san[n - 2] < 'a' || san[n - 2] > 'h' || san[n - 1] < '1' ||
+        san[n - 1] > '8')
+        return PGN_ERR_SAN;
+
+    M->dest.col = (myint8_t)(san[n - 2] - 'a');
+    M->dest.row = (myint8_t)('8' - san[n - 1]);
+    n -= 2;
+
+    if (morph != cpEEMPTY && M->dest.row != (turn == cpWTURN ? 0 : 7))
+        return PGN_ERR_SAN;
+
+    if (n > i && (san[n - 1] == 'x' || san[n - 1] == ':'))
+    {
+        capture = 1;
+        --n;
+    }
+
+    /* Disambiguation */
+    for (; i < n; ++i)
+    {
+        if (san[i] >= 'a' && san[i] <= 'h')
+            from_col = san[i] - 'a';
+        else if (san[i] >= '1' && san[i] <= '8')
+            from_row = '8' - san[i];
+        else
+            return PGN_ERR_SAN;
+    }
+
+    /* A pawn capture names its source file, any other pawn move stays on
+     * its file */
+    if (piece == cpWPAWN || piece == cpBPAWN)
+    {
+        if (capture == (from_col == -1))
+            return PGN_ERR_SAN;
+
+        if (!capture)
+            from_col = M->dest.col;
+    }
+
+    /* The capture marker is not optional: there is no en passant, so a
+     * capture always lands on a piece and any other move on an empty
+     * square */
+    if (capture == (board_get_at(B, &M->dest) == cpEEMPTY))
+        return PGN_ERR_SAN_ILLEGAL;
+
+    /* Ambiguity only matters among legal moves: a pinned piece does not need
+     * to be told apart */
+    candidate.dest = M->dest;
+    for (candidate.source.row = 0; candidate.source.row < 8;
+         ++candidate.source.row)
+    {
+        if (from_row != -1 && candidate.source.row != from_row)
+            continue;
+
+        for (candidate.source.col = 0; candidate.source.col < 8;
+             ++candidate.source.col)
+        {
+            if (from_col != -1 && candidate.source.col != from_col)
+                continue;
+
+            if (board_get_at(B, &candidate.source) != piece)
+                continue;
+
+            move_set_offset(&candidate);
+            if (board_check_move(B, &candidate, morph, turn, &whence) != NULL)
+                continue;
+
+            if (++found > 1)
+                return PGN_ERR_SAN_AMBIGUOUS;
+
+            *M = candidate;
+        }
+    }
+
+    if (found == 0)
+        return PGN_ERR_SAN_ILLEGAL;
+
+    *pawn_morph = morph;
+
+    return NULL;
+}
+
+const char*
+pgn_replay(pgn_game_p G, pgn_visit_t visit, void* ctx, pgn_replay_p R)
+{
+    struct board_t B;
+    struct move_t  M;
+    turn_t         turn;
+    piece_t        morph;
+    const char*    cur;
+    const char*    err;
+    const char*    p;
+    int            result;
+
+    board_init(&B);
+    turn        = cpWTURN;
+    err         = NULL;
+    result      = -1;
+
+    R->moves    = 0;
+    R->fullmove = 1;
+    R->turn     = cpWTURN;
+    R->result   = PGN_RESULT_UNKNOWN;
+    R->tok      = NULL;
+    R->n        = 0;
+
+    for (cur = G->begin; cur < G->end && err == NULL;)
+    {
+        switch (*cur)
+        {
+        case '[':
+            R->tok = NULL;
+            err    = pgn_tag(&B, &turn, &R->result, &cur, G->end);
+            continue;
+        case '{':
+            cur = memchr(cur, '}', (size_t)(G->end - cur));
+            cur = cur == NULL ? G->end : cur + 1;
+            continue;
+        case ';':
+        case '%':
+            cur = memchr(cur, '\n', (size_t)(G->end - cur));
+            cur = cur == NULL ? G->end : cur + 1;
+            continue;
+        case '(':
+            cur = pgn_skip_variation(cur, G->end);
+            continue;
+        }
+
+        if (isspace((unsigned char)*cur) || *cur == ')' || *cur == '}')
+        {
+            ++cur;
+            continue;
+        }
+
+        R->tok = cur;
+        while (cur < G->end && !isspace((unsigned char)*cur) &&
+               strchr("{}();[", *cur) == NULL)
+            ++cur;
+        R->n = (size_t)(cur - R->tok);
+
+        if (*R->tok == '$')
+            continue;
+
+        result = pgn_result(R->tok, R->n);
+        if (result != -1)
+        {
+            R->result = result;
+            break;
+        }
+
+        /* Move number: "12.", "12..." or glued to the move ("12.e4") */
+        for (p = R->tok; p < cur && isdigit((unsigned char)*p); ++p)
+            ;
+        if (p < cur && *p == '.')
+        {
+            while (p < cur && *p == '.')
+                ++p;
+
+            R->n   = (size_t)(cur - p);
+            R->tok = p;
+            if (R->n == 0)
+                continue;
+        }
+
+        R->turn = turn;
+        err     = pgn_san_move(&B, turn, R->tok, R->n, &M, &morph);
+        if (err != NULL)
+            break;
+
+        if (visit != NULL && !visit(ctx, &B, turn, &M, morph))
+            break;
+
+        board_exec(&B, &M, morph);
+        ++R->moves;
+
+        if (turn != cpWTURN)
+            ++R->fullmove;
+        turn = (turn_t)~turn;
+    }
+
+    /* Stopped before the termination marker */
+    if (result == -1)
+    {
+        result = pgn_last_result(G);
+        if (result != -1)
+            R->result = result;
+    }
+
+    return err;
+}
+
+int pgn_foreach(
+    const char* fname, unsigned int nthreads, pgn_game_visit_t visit, void* ctx
+)
+{
+    struct pgn_run_t R;
+    struct stat      st;
+    pthread_t*       workers;
+    void*            text;
+    unsigned int     cur;
+    int              fd;
+
+    fd = open(fname, O_RDONLY);
+    if (fd == -1)
+    {
+        perror(fname);
+        return CHESS_FILE_ERROR;
+    }
+
+    if (fstat(fd, &st) == -1)
+    {
+        perror(fname);
+        close(fd);
+        return CHESS_FILE_ERROR;
+    }
+
+    /* An empty file cannot be mapped, but it is a valid (empty) PGN */
+    text = NULL;
+    if (st.st_size > 0)
+    {
+        text = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (text == MAP_FAILED)
+        {
+            perror(fname);
+            close(fd);
+            return CHESS_FILE_ERROR;
+        }
+
+        posix_madvise(text, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+    }
+
+    /* The mapping holds its own reference to the file */
+    close(fd);
+
+    if (nthreads == 0)
+        nthreads = cpu_count();
+
+    workers = malloc(nthreads * sizeof(pthread_t));
+    if (workers == NULL ||
+        !workq_init(&R.queue, sizeof(struct pgn_game_t), PGN_QUEUE_LENGTH))
+    {
+        free(workers);
+        if (text != NULL)
+            munmap(text, (size_t)st.st_size);
+        fprintf(stderr, "Error: out of memory.\n");
+        return CHESS_GAME_ERROR;
+    }
+
+    R.visit = visit;
+    R.ctx   = ctx;
+
+    for (R.workers = 0; R.workers < nthreads; ++R.workers)
+        if (pthread_create(workers + R.workers, NULL, pgn_worker, &R) != 0)
+            break;
+
+    if (text != NULL)
+        pgn_split(&R, text, (size_t)st.st_size);
+
+    workq_close(&R.queue);
+    for (cur = 0; cur < R.workers; ++cur)
+        pthread_join(workers[cur], NULL);
+
+    workq_destroy(&R.queue);
+    free(workers);
+    if (text != NULL)
+        munmap(text, (size_t)st.st_size);
+
+    return CHESS_OK;
+}
+
+int pgn_check(const char* fname, unsigned int nthreads)
+{
+    struct pgn_check_t C;
+    double             elapsed;
+    int                ret;
+
+    pthread_mutex_init(&C.report_lock, NULL);
+    C.games  = 0;
+    C.failed = 0;
+    C.moves  = 0;
+
+    elapsed  = clock_ms();
+    ret      = pgn_foreach(fname, nthreads, pgn_check_game, &C);
+    elapsed  = clock_ms() - elapsed;
+
+    pthread_mutex_destroy(&C.report_lock);
+
+    if (ret != CHESS_OK)
+        return ret;
+
+    printf(
+        "%lu games, %lu failed, %lu moves in %.3f s (%.0f games/s)\n",
+        C.games,
+        C.failed,
+        C.moves,
+        elapsed / 1000.0,
+        elapsed > 0 ? (double)C.games * 1000.0 / elapsed : 0.0
+    );
+
+    return C.failed == 0 ? CHESS_OK : CHESS_ASSERT_FAILED;
+}
+
+static void pgn_split(pgn_run_p R, const char* text, size_t size)
+{
+    struct pgn_game_t G;
+    const char*       end = text + size;
+    const char*       cur;
+    const char*       eol;
+    unsigned long     lineno;
+    int               in_moves   = 0;
+    int               in_comment = 0;
+
+    G.begin  = text;
+    G.number = 1;
+    G.lineno = 1;
+
+    /* A game is made of tag pairs followed by movetext: a tag pair after some
+     * movetext starts the next game. Braces are tracked so that a comment
+     * line starting with '[' is not taken for a tag pair */
+    for (cur = text, lineno = 1; cur < end; cur = eol + 1, ++lineno)
+    {
+        eol = memchr(cur, '\n', (size_t)(end - cur));
+        if (eol == NULL)
+            eol = end;
+
+        if (!in_comment && *cur == '[')
+        {
+            if (in_moves)
+            {
+                G.end = cur;
+                pgn_push(R, &G);
+
+                G.begin  = cur;
+                G.lineno = lineno;
+                ++G.number;
+                in_moves = 0;
+            }
+
+            continue;
+        }
+
+        if (!in_comment && *cur == '%')
+            continue;
+
+        for (; cur < eol; ++cur)
+        {
+            if (in_comment)
+                in_comment = *cur != '}';
+            else if (*cur == '{')
+                in_comment = 1;
+            else if (*cur == ';')
+                break;
+            else if (!isspace((unsigned char)*cur))
+                in_moves = 1;
+        }
+    }
+
+    if (in_moves)
+    {
+        G.end = end;
+        pgn_push(R, &G);
+    }
+}
+
+static void pgn_push(pgn_run_p R, pgn_game_p G)
+{
+    /* Without workers nobody would pop: the game is visited right away */
+    if (R->workers == 0)
+        R->visit(R->ctx, G);
+    else
+        workq_push(&R->queue, G);
+}
+
+static void* pgn_worker(void* arg)
+{
+    pgn_run_p         R = arg;
+    struct pgn_game_t G;
+
+    while (workq_pop(&R->queue, &G))
+        R->visit(R->ctx, &G);
+
+    return NULL;
+}
+
+static void pgn_check_game(void* ctx, pgn_game_p G)
+{
+    pgn_check_p         C = ctx;
+    struct pgn_replay_t R;
+    const char*         err;
+
+    err = pgn_replay(G, NULL, NULL, &R);
+
+    pthread_mutex_lock(&C->report_lock);
+
+    ++C->games;
+    C->moves += R.moves;
+
+    if (err != NULL)
+    {
+        ++C->failed;
+
+        if (R.tok == NULL)
+            printf("game %lu (line %lu): %s\n", G->number, G->lineno, err);
+        else
+            printf(
+                "game %lu (line %lu): %lu%s %.*s: %s\n",
+                G->number,
+                G->lineno,
+                R.fullmove,
+                R.turn == cpWTURN ? "." : "...",
+                (int)R.n,
+                R.tok,
+                err
+            );
+    }
+
+    pthread_mutex_unlock(&C->report_lock);
+}
+
+static const char* pgn_tag(
+    board_p B, turn_t* turn, int* result, const char** cur, const char* end
+)
+{
+    char        value[PGN_FEN_LENGTH];
+    const char* p = *cur + 1;
+    const char* name;
+    size_t      name_n;
+    size_t      len;
+
+    while (p < end && isspace((unsigned char)*p))
+        ++p;
+
+    name = p;
+    while (p < end && (isalnum((unsigned char)*p) || *p == '_'))
+        ++p;
+    name_n = (size_t)(p - name);
+
+    while (p < end && isspace((unsigned char)*p))
+        ++p;
+
+    if (name_n == 0 || p == end || *p != '"')
+        return PGN_ERR_TAG;
+
+    /* The value is kept only as far as it fits: only FEN and Result are
+     * needed */
+    for (++p, len = 0; p < end && *p != '"'; ++p, ++len)
+    {
+        if (*p == '\\' && p + 1 < end)
+            ++p;
+
+        if (len < sizeof(value))
+            value[len] = *p;
+    }
+
+    if (p == end)
+        return PGN_ERR_TAG;
+
+    for (++p; p < end && isspace((unsigned char)*p); ++p)
+        ;
+
+    if (p == end || *p != ']')
+        return PGN_ERR_TAG;
+
+    *cur = p + 1;
+
+    if (name_n == 6 && strncmp(name, "Result", 6) == 0)
+    {
+        if (len < sizeof(value) && pgn_result(value, len) != -1)
+            *result = pgn_result(value, len);
+
+        return NULL;
+    }
+
+    if (name_n != 3 || strncmp(name, "FEN", 3) != 0)
+        return NULL;
+
+    if (len >= sizeof(value))
+        return PGN_ERR_FEN;
+
+    value[len] = '\0';
+
+    return board_from_fen(B, turn, value, NULL);
+}
+
+static const char* pgn_skip_variation(const char* cur, const char* end)
+{
+    int depth = 0;
+
+    for (; cur < end; ++cur)
+    {
+        if (*cur == '(')
+            ++depth;
+        else if (*cur == ')' && --depth == 0)
+            return cur + 1;
+        else if (*cur == '{')
+        {
+            cur = memchr(cur, '}', (size_t)(end - cur));
+            if (cur == NULL)
+                return end;
+        }
+        else if (*cur == ';')
+        {
+            cur = memchr(cur, '\n', (size_t)(end - cur));
+            if (cur == NULL)
+                return end;
+        }
+    }
+
+    return end;
+}
+
+static int pgn_result(const char* tok, size_t n)
+{
+    if (n == 1 && *tok == '*')
+        return PGN_RESULT_UNKNOWN;
+    if (n == 3 && strncmp(tok, "1-0", 3) == 0)
+        return PGN_RESULT_WHITE;
+    if (n == 3 && strncmp(tok, "0-1", 3) == 0)
+        return PGN_RESULT_BLACK;
+    if (n == 7 && strncmp(tok, "1/2-1/2", 7) == 0)
+        return PGN_RESULT_DRAW;
+
+    return -1;
+}
+
+static int pgn_last_result(pgn_game_p G)
+{
+    const char* end = G->end;
+    const char* tok;
+
+    while (end > G->begin && isspace((unsigned char)end[-1]))
+        --end;
+
+    for (tok = end; tok > G->begin && !isspace((unsigned char)tok[-1]); --tok)
+        ;
+
+    return pgn_result(tok, (size_t)(end - tok));
+}
@@ -0,0 +1,114 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_PGN_H
+#define CMC_CHESS_PGN_H
+
+#include <stddef.h>
+
+#include "board.h"
+#include "move.h"
+#include "piece.h"
+
+extern const char* PGN_ERR_SAN;
+extern const char* PGN_ERR_SAN_ILLEGAL;
+extern const char* PGN_ERR_SAN_AMBIGUOUS;
+extern const char* PGN_ERR_FEN;
+extern const char* PGN_ERR_TAG;
+
+enum
+{
+    PGN_RESULT_UNKNOWN, /* "*" or missing */
+    PGN_RESULT_WHITE,
+    PGN_RESULT_DRAW,
+    PGN_RESULT_BLACK
+};
+
+/* A game is a slice of a mapped PGN file */
+typedef struct pgn_game_t
+{
+    const char*   begin;
+    const char*   end;
+    unsigned long number; /* 1 based */
+    unsigned long lineno; /* Line of the first char of the game */
+}* pgn_game_p;
+
+/* Where pgn_replay stopped */
+typedef struct pgn_replay_t
+{
+    unsigned long moves;    /* Moves played */
+    unsigned long fullmove; /* Move number of the last move parsed */
+    turn_t        turn;     /* Side of the last move parsed */
+    int           result;   /* PGN_RESULT_* */
+
+    /* Last move parsed (n chars), NULL if the game failed in a tag */
+    const char* tok;
+    size_t      n;
+}* pgn_replay_p;
+
+/* Called by pgn_replay before each move is played on B.
+ *
+ * RETURN
+ * Zero to stop the replay before the move, non zero to go on.
+ */
+typedef int (*pgn_visit_t)(
+    void* ctx, board_p B, turn_t turn, move_p M, piece_t pawn_morph
+);
+
+/* Called by the workers of pgn_foreach, once for each game */
+typedef void (*pgn_game_visit_t)(void* ctx, pgn_game_p G);
+
+/* Resolve the SAN move san (n chars, not NUL terminated) against B, turn
+ * being the side to move, and set M and pawn_morph so that they can be passed
+ * to board_exec.
+ *
+ * Check and annotation suffixes ("+", "#", "!", "?") are accepted and
+ * ignored. Castling is not supported by the board. The capture marker ("x"
+ * or ":") must match the move: a capture lands on an enemy piece and, for a
+ * pawn, names its source file ("exd5"); any other move lands on an empty
+ * square and, for a pawn, stays on its file ("d5").
+ *
+ * RETURN
+ * NULL on success, PGN_ERR_SAN_* or ILLEGAL_MOVE_NOT_IMPLEMENTED_YET
+ * otherwise.
+ */
+extern const char* pgn_san_move(
+    board_p B, turn_t turn, const char* san, size_t n, move_p M,
+    piece_t* pawn_morph
+);
+
+/* Play the game G from the initial position (or the one of the FEN tag),
+ * calling visit (if not NULL) before each move, until it asks to stop.
+ * Comments, variations and NAGs are skipped. The result is taken from the
+ * termination marker (even if the replay stopped before it) or, if it is
+ * missing, from the Result tag.
+ *
+ * RETURN
+ * NULL if every move played is legal; the error of the first move that is
+ * not (R tells which) otherwise.
+ */
+extern const char*
+pgn_replay(pgn_game_p G, pgn_visit_t visit, void* ctx, pgn_replay_p R);
+
+/* Map the PGN file fname, split it into games and hand them to nthreads
+ * workers (one per CPU if nthreads is 0), that call visit. visit is called
+ * concurrently: ctx must be protected by the caller.
+ *
+ * RETURN
+ * An exit code (see exit_codes.h).
+ */
+extern int pgn_foreach(
+    const char* fname, unsigned int nthreads, pgn_game_visit_t visit, void* ctx
+);
+
+/* Check every game in the PGN file fname.
+ *
+ * Games are replayed in parallel (see pgn_foreach); the first illegal move
+ * of a game is reported, and the rest of the game is skipped.
+ *
+ * RETURN
+ * An exit code (see exit_codes.h).
+ */
+extern int pgn_check(const char* fname, unsigned int nthreads);
+
+#endif /* CMC_CHESS_PGN_H */
@@ -0,0 +1,77 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#define _POSIX_C_SOURCE 200809L
+#include "pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+void pool_init(pool_p P, size_t size)
+{
+    /* Room for the link of the free list */
+    P->size      = size < sizeof(void*) ? sizeof(void*) : size;
+    P->free      = NULL;
+    P->allocated = 0;
+    P->available = 0;
+
+    pthread_mutex_init(&P->lock, NULL);
+}
+
+void pool_destroy(pool_p P)
+{
+    void* block;
+
+    while (P->free != NULL)
+    {
+        block = P->free;
+        memcpy(&P->free, block, sizeof(void*));
+        free(block);
+    }
+
+    P->allocated -= P->available;
+    P->available  = 0;
+
+    pthread_mutex_destroy(&P->lock);
+}
+
+void* pool_get(pool_p P)
+{
+    void* block;
+
+    pthread_mutex_lock(&P->lock);
+
+    block = P->free;
+    if (block != NULL)
+    {
+        memcpy(&P->free, block, sizeof(void*));
+        --P->available;
+    }
+
+    pthread_mutex_unlock(&P->lock);
+
+    if (block != NULL)
+        return block;
+
+    block = malloc(P->size);
+    if (block == NULL)
+        return NULL;
+
+    pthread_mutex_lock(&P->lock);
+    ++P->allocated;
+    pthread_mutex_unlock(&P->lock);
+
+    return block;
+}
+
+void pool_put(pool_p P, void* block)
+{
+    pthread_mutex_lock(&P->lock);
+
+    memcpy(block, &P->free, sizeof(void*));
+    P->free = block;
+    ++P->available;
+
+    pthread_mutex_unlock(&P->lock);
+}
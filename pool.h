@@ -0,0 +1,37 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_POOL_H
+#define CMC_CHESS_POOL_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+/* Free list of fixed-size blocks shared by many threads.
+ *
+ * Blocks given back are kept for the next pool_get instead of being freed:
+ * a pool grows to the largest number of blocks in use at once, and costs
+ * one malloc per block over its whole life.
+ */
+typedef struct pool_t
+{
+    pthread_mutex_t lock;
+
+    size_t size;      /* Of a block */
+    void*  free;      /* Blocks given back, linked through their first bytes */
+    size_t allocated; /* Blocks obtained from malloc */
+    size_t available; /* Blocks in free */
+}* pool_p;
+
+extern void pool_init(pool_p P, size_t size);
+
+/* Free every block given back: blocks in use must not be given back after */
+extern void pool_destroy(pool_p P);
+
+/* RETURN
+ * A block of P->size bytes, NULL if memory could not be allocated.
+ */
+extern void* pool_get(pool_p P);
+extern void  pool_put(pool_p P, void* block);
+
+#endif /* CMC_CHESS_POOL_H */
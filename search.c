@@ -0,0 +1,325 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#include <stddef.h>
+
+#include "search.h"
+#include "util.h"
+
+/* Material, indexed by the absolute value of a piece */
+static const int SEARCH_VALUE[] = {0, 100, 500, 320, 330, 900, 0};
+
+/* Nodes between two looks at the clock */
+#define SEARCH_CLOCK_NODES 256
+
+static int search_node(
+    search_p S, board_p B, turn_t turn, int depth, int ply, int alpha, int beta
+);
+static int search_quiesce(
+    search_p S, board_p B, turn_t turn, int ply, int alpha, int beta
+);
+static int    search_eval(board_p B, turn_t turn);
+static int    search_in_check(board_p B, turn_t turn);
+static size_t search_captures(board_gen_p G, move16_t* M);
+static int    search_victim(board_p B, move16_t m);
+static void   search_order(board_p B, move16_t* M, size_t n, size_t first);
+static int    search_out_of_time(search_p S);
+
+void search_init(search_p S)
+{
+    S->max_depth = SEARCH_MAX_DEPTH;
+    S->deadline  = 0;
+    S->report    = NULL;
+    S->ctx       = NULL;
+    S->stop      = 0;
+    S->ponder    = 0;
+}
+
+int search_run(search_p S, board_p B, turn_t turn)
+{
+    move16_t       M[BOARD_MAX_MOVES];
+    struct board_t next;
+    size_t         n;
+    size_t         cur;
+    size_t         best;
+    int            depth;
+    int            alpha;
+    int            score;
+
+    S->depth   = 0;
+    S->score   = 0;
+    S->nodes   = 0;
+    S->stopped = 0;
+    S->start   = clock_ms();
+
+    n          = board_legal_moves(B, turn, M, BOARD_MAX_MOVES);
+    if (n == 0)
+        return 0;
+
+    move16_unpack(M[0], turn, &S->best, &S->best_morph);
+    search_order(B, M, n, n);
+
+    for (depth = 1; depth <= S->max_depth; ++depth)
+    {
+        alpha = -SEARCH_MATE - 1;
+        best  = 0;
+
+        for (cur = 0; cur < n; ++cur)
+        {
+            next = *B;
+            board_exec16(&next, M[cur]);
+
+            score = -search_node(
+                S, &next, (turn_t)~turn, depth - 1, 1, -SEARCH_MATE - 1, -alpha
+            );
+            if (S->stopped)
+                break;
+
+            if (score > alpha)
+            {
+                alpha = score;
+                best  = cur;
+            }
+        }
+
+        /* An interrupted iteration is thrown away */
+        if (S->stopped)
+            break;
+
+        S->depth = depth;
+        S->score = alpha;
+        move16_unpack(M[best], turn, &S->best, &S->best_morph);
+
+        if (S->report != NULL)
+            S->report(S->ctx, S);
+
+        /* Nothing deeper changes a forced mate */
+        if (search_mate_in(alpha) != 0)
+            break;
+
+        /* The best move is searched first by the next iteration */
+        search_order(B, M, n, best);
+    }
+
+    return 1;
+}
+
+int search_mate_in(int score)
+{
+    if (score > SEARCH_MATE - 2 * SEARCH_MAX_DEPTH)
+        return (SEARCH_MATE - score + 1) / 2;
+
+    if (score < -SEARCH_MATE + 2 * SEARCH_MAX_DEPTH)
+        return -(SEARCH_MATE + score) / 2;
+
+    return 0;
+}
+
+static int search_node(
+    search_p S, board_p B, turn_t turn, int depth, int ply, int alpha, int beta
+)
+{
+    struct board_gen_t G;
+    move16_t           M[BOARD_MAX_MOVES];
+    move16_t           m;
+    struct board_t     next;
+    size_t             n;
+    size_t             cur;
+    int                score;
+
+    if (depth == 0)
+        return search_quiesce(S, B, turn, ply, alpha, beta);
+
+    if (search_out_of_time(S))
+        return 0;
+
+    /* Captures and promotions by value, then the other moves as they come:
+     * a cutoff spares the generation of the ones left */
+    board_gen_init(&G, B, turn);
+    n = search_captures(&G, M);
+    search_order(B, M, n, n);
+
+    for (cur = 0; cur < n || board_gen_next(&G, BOARD_GEN_KING, &m); ++cur)
+    {
+        next = *B;
+        board_exec16(&next, cur < n ? M[cur] : m);
+
+        score = -search_node(
+            S, &next, (turn_t)~turn, depth - 1, ply + 1, -beta, -alpha
+        );
+        if (S->stopped)
+            return 0;
+
+        if (score >= beta)
+            return score;
+
+        if (score > alpha)
+            alpha = score;
+    }
+
+    if (cur == 0)
+        return search_in_check(B, turn) ? -SEARCH_MATE + ply : 0;
+
+    return alpha;
+}
+
+static int search_quiesce(
+    search_p S, board_p B, turn_t turn, int ply, int alpha, int beta
+)
+{
+    struct board_gen_t G;
+    move16_t           M[BOARD_MAX_MOVES];
+    struct board_t     next;
+    size_t             n;
+    size_t             cur;
+    int                score;
+
+    if (search_out_of_time(S))
+        return 0;
+
+    board_gen_init(&G, B, turn);
+    n = search_captures(&G, M);
+
+    /* Any other legal move tells checkmates apart */
+    if (n == 0 && !board_gen_next(&G, BOARD_GEN_KING, M))
+        return search_in_check(B, turn) ? -SEARCH_MATE + ply : 0;
+
+    score = search_eval(B, turn);
+    if (score >= beta)
+        return score;
+
+    if (score > alpha)
+        alpha = score;
+
+    search_order(B, M, n, n);
+
+    /* Captures and promotions come first: stop at the first quiet move */
+    for (cur = 0; cur < n && search_victim(B, M[cur]) > 0; ++cur)
+    {
+        next = *B;
+        board_exec16(&next, M[cur]);
+
+        score =
+            -search_quiesce(S, &next, (turn_t)~turn, ply + 1, -beta, -alpha);
+        if (S->stopped)
+            return 0;
+
+        if (score >= beta)
+            return score;
+
+        if (score > alpha)
+            alpha = score;
+    }
+
+    return alpha;
+}
+
+static int search_eval(board_p B, turn_t turn)
+{
+    int sq;
+    int i;
+    int score = 0;
+
+    /* The squares of the white pieces come first in the list, then the ones
+     * of the black pieces: together they are the pieces on the board */
+    for (i = 0; i < B->count[BOARD_WHITE]; ++i)
+    {
+        sq = B->list[i];
+        score += SEARCH_VALUE[(int)board_at(B, sq)];
+
+        /* Pushing pawns is worth a little */
+        if (board_at(B, sq) == cpWPAWN)
+            score += 6 - sq / 8;
+    }
+
+    for (i = 64 - B->count[BOARD_BLACK]; i < 64; ++i)
+    {
+        sq = B->list[i];
+        score -= SEARCH_VALUE[-(int)board_at(B, sq)];
+
+        if (board_at(B, sq) == cpBPAWN)
+            score -= sq / 8 - 1;
+    }
+
+    return turn == cpWTURN ? score : -score;
+}
+
+static int search_in_check(board_p B, turn_t turn)
+{
+    struct coord_t whence;
+
+    whence.row = whence.col = -1;
+    board_under_check_part(
+        B, turn == cpWTURN ? &B->wking : &B->bking, &whence
+    );
+
+    return whence.row != -1;
+}
+
+/* List the moves of the first stage of G into M */
+static size_t search_captures(board_gen_p G, move16_t* M)
+{
+    size_t n = 0;
+
+    while (n < BOARD_MAX_MOVES && board_gen_next(G, BOARD_GEN_CAPTURES, M + n))
+        ++n;
+
+    return n;
+}
+
+static int search_victim(board_p B, move16_t m)
+{
+    piece_t victim = board_at(B, move16_dest(m));
+    int     mph    = move16_morph(m);
+
+    /* SEARCH_VALUE[cpEEMPTY] is 0: no morph, no value */
+    return SEARCH_VALUE[victim < 0 ? -victim : victim] + SEARCH_VALUE[mph];
+}
+
+/* Move first (if < n) to the front, then captures and promotions by value
+ * (stable insertion sort: lists are short) */
+static void search_order(board_p B, move16_t* M, size_t n, size_t first)
+{
+    move16_t tmp_move;
+    int      value[BOARD_MAX_MOVES];
+    int      tmp_value;
+    size_t   i;
+    size_t   j;
+
+    for (i = 0; i < n; ++i)
+        value[i] = search_victim(B, M[i]);
+
+    if (first < n)
+        value[first] = SEARCH_MATE;
+
+    for (i = 1; i < n; ++i)
+    {
+        tmp_move  = M[i];
+        tmp_value = value[i];
+
+        for (j = i; j > 0 && value[j - 1] < tmp_value; --j)
+        {
+            M[j]     = M[j - 1];
+            value[j] = value[j - 1];
+        }
+
+        M[j]     = tmp_move;
+        value[j] = tmp_value;
+    }
+}
+
+/* Polled at every node: a stop is seen within one node. The stop flag only
+ * has to be seen eventually (relaxed); ponder also publishes deadline */
+static int search_out_of_time(search_p S)
+{
+    ++S->nodes;
+
+    if (__atomic_load_n(&S->stop, __ATOMIC_RELAXED))
+        S->stopped = 1;
+    else if (S->nodes % SEARCH_CLOCK_NODES == 0 &&
+             !__atomic_load_n(&S->ponder, __ATOMIC_ACQUIRE) &&
+             S->deadline != 0 && clock_ms() >= S->deadline)
+        S->stopped = 1;
+
+    return S->stopped;
+}
@@ -0,0 +1,68 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_SEARCH_H
+#define CMC_CHESS_SEARCH_H
+
+#include "board.h"
+#include "move.h"
+#include "piece.h"
+
+/* Iterative deepening alpha-beta search over board_legal_moves, with a
+ * material evaluation and a captures-only quiescence search. */
+
+#define SEARCH_MAX_DEPTH 64
+
+/* Score of being checkmated at the root, in centipawns; a mate n plies away
+ * scores SEARCH_MATE - n (from the point of view of the winner) */
+#define SEARCH_MATE 30000
+
+struct search_t;
+
+/* Called after every completed iteration */
+typedef void (*search_report_t)(void* ctx, struct search_t* S);
+
+typedef struct search_t
+{
+    /* Limits, set by the caller */
+    int    max_depth; /* 1..SEARCH_MAX_DEPTH */
+    double deadline;  /* In clock_ms() time, 0 for none */
+
+    search_report_t report; /* May be NULL */
+    void*           ctx;
+
+    /* Set atomically by any thread to stop the search at the next node */
+    int stop;
+
+    /* While set (atomically), the deadline does not run (pondering). A thread
+     * clearing it sets deadline first, then clears it with release order */
+    int ponder;
+
+    /* Result of the last completed iteration (any legal move if none) */
+    int           depth;
+    int           score; /* From the point of view of the side to move */
+    struct move_t best;
+    piece_t       best_morph;
+    unsigned long nodes;
+    double        start; /* In clock_ms() time */
+
+    int stopped;
+}* search_p;
+
+/* No limits, stop and ponder cleared */
+extern void search_init(search_p S);
+
+/* Search B, turn being the side to move.
+ *
+ * RETURN
+ * 1 if S->best is set, 0 if turn has no legal move.
+ */
+extern int search_run(search_p S, board_p B, turn_t turn);
+
+/* RETURN
+ * The number of moves to mate (negative if the side to move is mated) if
+ * score is a mate score, 0 otherwise.
+ */
+extern int search_mate_in(int score);
+
+#endif /* CMC_CHESS_SEARCH_H */
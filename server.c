@@ -0,0 +1,425 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "exit_codes.h"
+#include "game.h"
+#include "pool.h"
+#include "server.h"
+#include "util.h"
+
+/* Events taken by a worker per wake up: one, so that a slow command (such
+ * as .analyze on a deep position) does not hold other ready sessions back */
+#define SERVER_EVENTS 1
+
+typedef struct server_t
+{
+    int listen_fd;
+    int epoll_fd;
+    int spare_fd; /* Given up to drop a client when out of descriptors */
+
+    struct pool_t games; /* Of the cold state of the games */
+    struct pool_t bufs;  /* Of struct server_buf_t */
+}* server_p;
+
+/* Buffers of a session, held only while it is busy (see server_rest) */
+typedef struct server_buf_t
+{
+    FILE* out; /* On a dup of fd: closing it leaves fd open */
+    char  out_buf[SERVER_OUT_BUFFER];
+
+    /* Bytes received and not yet part of a whole line */
+    char   in[GAME_COMMAND_LENGTH];
+    size_t in_len;
+}* server_buf_p;
+
+typedef struct server_session_t
+{
+    struct game_t game;
+    int           fd;
+    server_buf_p  buf; /* NULL while idle */
+}* server_session_p;
+
+static int   server_listen(server_p V, const char* path);
+static void* server_worker(void* arg);
+static void  server_accept(server_p V);
+static void  server_open(server_p V, int fd);
+static int   server_read(server_p V, server_session_p S);
+static int   server_busy(server_p V, server_session_p S);
+static void  server_rest(server_p V, server_session_p S);
+static void  server_close(server_p V, server_session_p S);
+static int   server_arm(server_p V, int op, int fd, void* ptr);
+
+int server_run(const char* path, unsigned int nthreads)
+{
+    struct server_t V;
+    pthread_t*      threads;
+    unsigned int    i;
+    unsigned int    started;
+
+    if (nthreads == 0)
+        nthreads = cpu_count();
+
+    threads = malloc(nthreads * sizeof(pthread_t));
+    if (threads == NULL)
+    {
+        fprintf(stderr, "Error: out of memory.\n");
+        return CHESS_SERVER_ERROR;
+    }
+
+    /* A client going away must not kill the server on the next write */
+    signal(SIGPIPE, SIG_IGN);
+
+    if (!server_listen(&V, path))
+    {
+        free(threads);
+        return CHESS_SERVER_ERROR;
+    }
+
+    game_pool_init(&V.games);
+    pool_init(&V.bufs, sizeof(struct server_buf_t));
+
+    printf("Listening on %s\n", path);
+    fflush(stdout);
+
+    for (started = 0; started < nthreads; ++started)
+        if (pthread_create(threads + started, NULL, server_worker, &V) != 0)
+            break;
+
+    if (started == 0)
+        server_worker(&V);
+
+    /* Workers return only if epoll fails */
+    for (i = 0; i < started; ++i)
+        pthread_join(threads[i], NULL);
+
+    close(V.epoll_fd);
+    close(V.listen_fd);
+    if (V.spare_fd >= 0)
+        close(V.spare_fd);
+    pool_destroy(&V.bufs);
+    pool_destroy(&V.games);
+    free(threads);
+
+    return CHESS_SERVER_ERROR;
+}
+
+static int server_listen(server_p V, const char* path)
+{
+    struct sockaddr_un addr;
+    struct stat        st;
+
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "Error: `%s`: path too long.\n", path);
+        return 0;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    /* Left behind by a server that was killed */
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(path);
+
+    V->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (V->listen_fd < 0)
+    {
+        fprintf(stderr, "Error: socket: %s.\n", strerror(errno));
+        return 0;
+    }
+
+    /* Accepted until EAGAIN: accepting must not block */
+    if (fcntl(V->listen_fd, F_SETFL, O_NONBLOCK) != 0 ||
+        bind(V->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(V->listen_fd, SERVER_BACKLOG) != 0)
+    {
+        fprintf(stderr, "Error: `%s`: %s.\n", path, strerror(errno));
+        close(V->listen_fd);
+        return 0;
+    }
+
+    V->epoll_fd = epoll_create1(0);
+    if (V->epoll_fd < 0)
+    {
+        fprintf(stderr, "Error: epoll: %s.\n", strerror(errno));
+        close(V->listen_fd);
+        return 0;
+    }
+
+    V->spare_fd = open("/dev/null", O_RDONLY);
+    if (V->spare_fd < 0)
+    {
+        fprintf(stderr, "Error: /dev/null: %s.\n", strerror(errno));
+        close(V->epoll_fd);
+        close(V->listen_fd);
+        return 0;
+    }
+
+    /* The listening socket is told apart by its NULL session */
+    if (!server_arm(V, EPOLL_CTL_ADD, V->listen_fd, NULL))
+    {
+        fprintf(stderr, "Error: epoll: %s.\n", strerror(errno));
+        close(V->spare_fd);
+        close(V->epoll_fd);
+        close(V->listen_fd);
+        return 0;
+    }
+
+    return 1;
+}
+
+static void* server_worker(void* arg)
+{
+    server_p           V = arg;
+    struct epoll_event events[SERVER_EVENTS];
+    server_session_p   S;
+    int                n;
+    int                i;
+
+    for (;;)
+    {
+        n = epoll_wait(V->epoll_fd, events, SERVER_EVENTS, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            fprintf(stderr, "Error: epoll: %s.\n", strerror(errno));
+            return NULL;
+        }
+
+        for (i = 0; i < n; ++i)
+        {
+            S = events[i].data.ptr;
+
+            if (S == NULL)
+                server_accept(V);
+            else if (!server_read(V, S) ||
+                     !server_arm(V, EPOLL_CTL_MOD, S->fd, S))
+                server_close(V, S);
+        }
+    }
+}
+
+/* The listening socket is armed for one event at a time: a single worker
+ * runs this, the spare descriptor is its own */
+static void server_accept(server_p V)
+{
+    int fd;
+
+    for (;;)
+    {
+        fd = accept(V->listen_fd, NULL, NULL);
+        if (fd >= 0)
+            server_open(V, fd);
+        else if ((errno == EMFILE || errno == ENFILE) && V->spare_fd >= 0)
+        {
+            /* Out of descriptors: a client left in the backlog would keep
+             * the socket readable and the workers spinning, drop it */
+            close(V->spare_fd);
+            fd = accept(V->listen_fd, NULL, NULL);
+            if (fd >= 0)
+                close(fd);
+
+            V->spare_fd = open("/dev/null", O_RDONLY);
+        }
+        else if (errno != EINTR && errno != ECONNABORTED)
+            break;
+    }
+
+    server_arm(V, EPOLL_CTL_MOD, V->listen_fd, NULL);
+}
+
+static void server_open(server_p V, int fd)
+{
+    server_session_p S;
+    struct timeval   timeout;
+
+    S = malloc(sizeof(struct server_session_t));
+    if (S == NULL)
+    {
+        close(fd);
+        return;
+    }
+
+    /* Writes block (for at most SERVER_SEND_TIMEOUT), reads follow epoll */
+    timeout.tv_sec  = SERVER_SEND_TIMEOUT;
+    timeout.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    S->fd  = fd;
+    S->buf = NULL;
+    game_init(&S->game, GOPT_REMOTE);
+    game_io_init(&S->game.io, NULL, NULL);
+    S->game.pool = &V->games;
+
+    if (!server_busy(V, S))
+    {
+        server_close(V, S);
+        return;
+    }
+
+    game_start(&S->game);
+    fflush(S->buf->out);
+    server_rest(V, S);
+
+    if (S->game.done != NULL || !server_arm(V, EPOLL_CTL_ADD, fd, S))
+        server_close(V, S);
+}
+
+/* RETURN
+ * 1 if the session goes on, 0 if it is over.
+ */
+static int server_read(server_p V, server_session_p S)
+{
+    server_buf_p B;
+    ssize_t      n;
+    char*        line;
+    char*        end;
+    char*        nl;
+    int          ok;
+
+    if (!server_busy(V, S))
+        return 0;
+
+    B = S->buf;
+    n = recv(S->fd, B->in + B->in_len, sizeof(B->in) - 1 - B->in_len, 0);
+    if (n < 0 && errno == EINTR)
+        return 1;
+
+    if (n <= 0)
+        return 0;
+
+    B->in_len += (size_t)n;
+    line = B->in;
+    end  = B->in + B->in_len;
+
+    while (S->game.done == NULL &&
+           (nl = memchr(line, '\n', (size_t)(end - line))) != NULL)
+    {
+        *nl = '\0';
+        game_input(&S->game, line);
+        line = nl + 1;
+    }
+
+    /* A line longer than a command is split, as fgets would do */
+    if (S->game.done == NULL && B->in_len == sizeof(B->in) - 1 &&
+        line == B->in)
+    {
+        *end = '\0';
+        game_input(&S->game, line);
+        line = end;
+    }
+
+    B->in_len = (size_t)(end - line);
+    memmove(B->in, line, B->in_len);
+
+    if (S->game.done == GAME_DONE_COMM_QUIT)
+        fprintf(B->out, "Bye\n");
+    else if (S->game.done != NULL)
+        fprintf(B->out, "Error: %s.\n", S->game.done);
+
+    fflush(B->out);
+    ok = S->game.done == NULL && !ferror(B->out);
+
+    if (ok)
+        server_rest(V, S);
+
+    return ok;
+}
+
+/* Take the buffers of S (and the output stream of its game).
+ *
+ * RETURN
+ * 0 if they could not be allocated.
+ */
+static int server_busy(server_p V, server_session_p S)
+{
+    server_buf_p B;
+    int          fd;
+
+    if (S->buf != NULL)
+        return 1;
+
+    B = pool_get(&V->bufs);
+    if (B == NULL)
+        return 0;
+
+    fd = dup(S->fd);
+    if (fd < 0)
+    {
+        pool_put(&V->bufs, B);
+        return 0;
+    }
+
+    B->out = fdopen(fd, "w");
+    if (B->out == NULL)
+    {
+        close(fd);
+        pool_put(&V->bufs, B);
+        return 0;
+    }
+
+    setvbuf(B->out, B->out_buf, _IOFBF, sizeof(B->out_buf));
+    B->in_len      = 0;
+    S->buf         = B;
+    S->game.io.out = B->out;
+
+    return 1;
+}
+
+/* Give the buffers of S back, unless its game or a partial line needs them:
+ * an idle session costs struct server_session_t alone */
+static void server_rest(server_p V, server_session_p S)
+{
+    if (S->buf == NULL || S->buf->in_len != 0 || !game_idle(&S->game))
+        return;
+
+    fclose(S->buf->out);
+    pool_put(&V->bufs, S->buf);
+    S->buf         = NULL;
+    S->game.io.out = NULL;
+}
+
+static void server_close(server_p V, server_session_p S)
+{
+    /* The analysis may still write to the output stream */
+    game_end(&S->game);
+
+    if (S->buf != NULL)
+    {
+        fclose(S->buf->out);
+        pool_put(&V->bufs, S->buf);
+    }
+
+    /* Also takes the socket out of the epoll set */
+    close(S->fd);
+    free(S);
+}
+
+/* (Re)enable one event of fd: a session is served by one worker at a time */
+static int server_arm(server_p V, int op, int fd, void* ptr)
+{
+    struct epoll_event ev;
+
+    ev.events   = EPOLLIN | EPOLLONESHOT;
+    ev.data.ptr = ptr;
+
+    return epoll_ctl(V->epoll_fd, op, fd, &ev) == 0;
+}
@@ -0,0 +1,41 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_SERVER_H
+#define CMC_CHESS_SERVER_H
+
+/* Game server.
+ *
+ * Listens on a Unix domain socket; every connection is a game of its own,
+ * played with the commands of the REPL (one per line) and answered with
+ * what the REPL would print. The game is over when the client sends quit
+ * (answered with "Bye") or an assertion fails; closing the connection drops
+ * it.
+ *
+ * Sessions are multiplexed with epoll over a pool of worker threads: a
+ * session is served by one worker at a time, a worker serves any session.
+ * .tbgen and .tbload are refused: tablebases are shared by the process.
+ * Clients connecting while the process is out of file descriptors are
+ * accepted and closed at once.
+ *
+ * The server runs until it is killed.
+ */
+
+/* Sessions waiting to be accepted */
+#define SERVER_BACKLOG 128
+
+/* A client not reading its answers holds a worker at most this long */
+#define SERVER_SEND_TIMEOUT 5
+
+/* Output buffered per session: a rendered board and its messages */
+#define SERVER_OUT_BUFFER 2048
+
+/* Serve on the socket path (replacing a stale socket), with nthreads
+ * workers (one per CPU if nthreads is 0).
+ *
+ * RETURN
+ * An exit code (see exit_codes.h): only on errors.
+ */
+extern int server_run(const char* path, unsigned int nthreads);
+
+#endif /* CMC_CHESS_SERVER_H */
@@ -0,0 +1,1102 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "attack.h"
+#include "tb.h"
+#include "util.h"
+
+const char* TB_ERR_SIG     = "bad material signature";
+const char* TB_ERR_MEMORY  = "out of memory";
+const char* TB_ERR_FULL    = "too many tables";
+const char* TB_ERR_MISSING = "no table for this material";
+const char* TB_ERR_NO_MOVE = "no legal move";
+const char* TB_ERR_OPEN    = "could not open table file";
+const char* TB_ERR_MAP     = "could not map table file in memory";
+const char* TB_ERR_MAGIC   = "not a table file";
+const char* TB_ERR_VERSION = "unsupported table file version";
+const char* TB_ERR_CORRUPT = "table file is corrupt";
+
+static const char*     TB_MAGIC       = "CMCT";
+static const myuint8_t TB_VERSION     = 1;
+static const myuint8_t TB_COMPRESSION = 1;
+
+#define TB_MAX_TABLES 64
+
+/* Piece letters, strongest first: signatures list pieces in this order */
+static const char* TB_LETTERS = "KQRBNP";
+
+typedef struct tb_t
+{
+    char       sig[TB_SIG_LENGTH];
+    piece_t    pieces[TB_MAX_PIECES]; /* pieces[0] is cpWKING */
+    int        npieces;
+    int        pawns; /* 1 if there is a pawn: left-right symmetry only */
+    size_t     kings; /* Squares the white king is restricted to */
+    size_t     size;
+    int        deepest; /* Largest value, TB_INVALID excluded */
+
+    myuint8_t*       dtm;  /* Generated tables, NULL if mapped */
+    const myuint8_t* base; /* Mapped tables, NULL if generated */
+    size_t           base_size;
+    size_t           blocks;
+}* tb_p;
+
+typedef struct tb_cache_t
+{
+    tb_p          T; /* NULL if unused */
+    size_t        block;
+    unsigned long used; /* Time of the last use */
+    myuint8_t     data[TB_BLOCK_SIZE];
+}* tb_cache_p;
+
+/* A slice of a generation pass, run by one thread */
+typedef struct tb_pass_t
+{
+    tb_p   T;
+    int    depth;
+    size_t begin;
+    size_t end;
+    size_t changed;
+    int    started; /* Run by a thread of its own */
+}* tb_pass_p;
+
+/* Registered tables, shared by every game of the process (see tb.h). Only
+ * tb_register adds to them, with tb_write_lock held: the thread generating or
+ * loading reads them without tb_registry_lock */
+static tb_p             tb_tables[TB_MAX_TABLES];
+static size_t           tb_count         = 0;
+static pthread_rwlock_t tb_registry_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/* Held by tb_generate and tb_load: one of them runs at a time */
+static pthread_mutex_t tb_write_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* White king squares by index and indexes by square (-1 outside of the
+ * region), without ([0]) and with ([1]) pawns */
+static int            tb_ksq[2][32];
+static int            tb_kidx[2][64];
+static pthread_once_t tb_region_once = PTHREAD_ONCE_INIT;
+
+/* Decompressed blocks of mapped tables */
+static struct tb_cache_t tb_cache[TB_CACHE_BLOCKS];
+static unsigned long     tb_cache_clock = 0;
+static pthread_mutex_t   tb_cache_lock  = PTHREAD_MUTEX_INITIALIZER;
+
+static void        tb_region_init(void);
+static const char* tb_parse(const char* sig, tb_p T);
+static int         tb_board_sig(board_p B, char* sig);
+static void        tb_pieces_sig(const piece_t* pieces, int n, char* sig);
+static void        tb_flip_sig(const char* sig, char* flipped);
+static void        tb_flip_board(board_p B, board_p F);
+static tb_p        tb_find(const char* sig);
+static int         tb_transform(int sq, int t);
+static size_t      tb_index(tb_p T, board_p B, turn_t turn);
+static int         tb_decode(tb_p T, size_t idx, board_p B, turn_t* turn);
+static const char* tb_build(tb_p T, unsigned int nthreads);
+static const char*
+tb_build_sub(const piece_t* pieces, int n, unsigned int nthreads);
+static size_t      tb_run_pass(tb_p T, int depth, unsigned int nthreads);
+static void*       tb_pass(void* arg);
+static int         tb_value(tb_p T, size_t idx);
+static int         tb_inflate(tb_p T, size_t block, myuint8_t* data);
+static size_t      tb_deflate(const myuint8_t* data, size_t n, myuint8_t* out);
+static tb_p        tb_register(tb_p T);
+static void          tb_put(myuint8_t* p, unsigned long v, int bytes);
+static unsigned long tb_get(const myuint8_t* p, int bytes);
+
+const char* tb_generate(const char* sig, unsigned int nthreads)
+{
+    struct tb_t T;
+    const char* err;
+
+    pthread_once(&tb_region_once, tb_region_init);
+
+    err = tb_parse(sig, &T);
+    if (err != NULL)
+        return err;
+
+    if (nthreads == 0)
+        nthreads = cpu_count();
+
+    pthread_mutex_lock(&tb_write_lock);
+    if (tb_find(T.sig) == NULL)
+        err = tb_build(&T, nthreads);
+    pthread_mutex_unlock(&tb_write_lock);
+
+    return err;
+}
+
+const char* tb_probe(board_p B, turn_t turn, int* dtm)
+{
+    struct board_t F;
+    char           sig[TB_SIG_LENGTH];
+    char           flipped[TB_SIG_LENGTH];
+    tb_p           T;
+    size_t         idx;
+
+    if (!tb_board_sig(B, sig))
+        return TB_ERR_MISSING;
+
+    T = tb_find(sig);
+    if (T == NULL)
+    {
+        /* Same table, colours swapped */
+        tb_flip_sig(sig, flipped);
+        T = tb_find(flipped);
+        if (T == NULL)
+            return TB_ERR_MISSING;
+
+        tb_flip_board(B, &F);
+        B    = &F;
+        turn = (turn_t)~turn;
+    }
+
+    idx = tb_index(T, B, turn);
+    if (idx >= T->size)
+        return TB_ERR_MISSING;
+
+    *dtm = tb_value(T, idx);
+    if (*dtm == -1)
+        return TB_ERR_CORRUPT;
+
+    return NULL;
+}
+
+const char* tb_save(const char* sig, const char* fname)
+{
+    struct tb_t      S;
+    tb_p             T;
+    FILE*            fp;
+    myuint8_t        header[TB_HEADER_SIZE];
+    myuint8_t*       index;
+    myuint8_t*       block;
+    myuint8_t*       out;
+    const myuint8_t* data;
+    const char*      err;
+    size_t           blocks;
+    size_t           i;
+    size_t           n;
+    unsigned long    offset;
+    int              ok;
+
+    err = tb_parse(sig, &S);
+    if (err != NULL)
+        return err;
+
+    T = tb_find(S.sig);
+    if (T == NULL)
+        return TB_ERR_MISSING;
+
+    blocks = (T->size + TB_BLOCK_SIZE - 1) / TB_BLOCK_SIZE;
+
+    /* A compressed block is at most 1/128 larger */
+    index  = malloc(8 * (blocks + 1));
+    block  = malloc(TB_BLOCK_SIZE);
+    out    = malloc(2 * TB_BLOCK_SIZE);
+    fp     = index && block && out ? fopen(fname, "wb") : NULL;
+    if (fp == NULL)
+    {
+        free(index);
+        free(block);
+        free(out);
+        return index && block && out ? TB_ERR_OPEN : TB_ERR_MEMORY;
+    }
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, TB_MAGIC, 4);
+    header[4] = TB_VERSION;
+    header[5] = TB_COMPRESSION;
+    header[6] = (myuint8_t)T->deepest;
+    memcpy(header + 8, T->sig, strlen(T->sig));
+    tb_put(header + 16, TB_BLOCK_SIZE, 4);
+    tb_put(header + 20, blocks, 4);
+    tb_put(header + 24, T->size, 8);
+    ok = fwrite(header, TB_HEADER_SIZE, 1, fp) == 1;
+
+    /* The block index is written once the size of every block is known */
+    offset = TB_HEADER_SIZE + 8 * (blocks + 1);
+    ok     = ok && fseek(fp, (long)offset, SEEK_SET) == 0;
+
+    for (i = 0; i < blocks && ok; ++i)
+    {
+        n = i + 1 == blocks ? T->size - i * TB_BLOCK_SIZE : TB_BLOCK_SIZE;
+
+        if (T->dtm != NULL)
+            data = T->dtm + i * TB_BLOCK_SIZE;
+        else if (tb_inflate(T, i, block))
+            data = block;
+        else
+            break;
+
+        tb_put(index + 8 * i, offset, 8);
+
+        n  = tb_deflate(data, n, out);
+        ok = fwrite(out, n, 1, fp) == 1;
+        offset += (unsigned long)n;
+    }
+
+    tb_put(index + 8 * blocks, offset, 8);
+    ok = ok && fseek(fp, TB_HEADER_SIZE, SEEK_SET) == 0 &&
+         fwrite(index, 8 * (blocks + 1), 1, fp) == 1;
+
+    free(index);
+    free(block);
+    free(out);
+
+    if (fclose(fp) != 0 || !ok)
+        return TB_ERR_OPEN;
+
+    return i == blocks ? NULL : TB_ERR_CORRUPT;
+}
+
+const char* tb_load(const char* fname)
+{
+    struct stat st;
+    struct tb_t      T;
+    char             sig[TB_SIG_LENGTH + 1];
+    void*            base;
+    const myuint8_t* p;
+    const char* err;
+    size_t      i;
+    size_t      prev;
+    size_t      cur;
+    int         fd;
+
+    pthread_once(&tb_region_once, tb_region_init);
+
+    fd = open(fname, O_RDONLY);
+    if (fd == -1)
+        return TB_ERR_OPEN;
+
+    if (fstat(fd, &st) == -1)
+    {
+        close(fd);
+        return TB_ERR_OPEN;
+    }
+
+    if (st.st_size < TB_HEADER_SIZE)
+    {
+        close(fd);
+        return TB_ERR_CORRUPT;
+    }
+
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    /* The mapping holds its own reference to the file */
+    close(fd);
+
+    if (base == MAP_FAILED)
+        return TB_ERR_MAP;
+
+    p = (const myuint8_t*)base;
+
+    if (memcmp(p, TB_MAGIC, 4) != 0)
+        err = TB_ERR_MAGIC;
+    else if (p[4] != TB_VERSION || p[5] != TB_COMPRESSION ||
+             tb_get(p + 16, 4) != TB_BLOCK_SIZE)
+        err = TB_ERR_VERSION;
+    else
+    {
+        memcpy(sig, p + 8, TB_SIG_LENGTH);
+        sig[TB_SIG_LENGTH] = '\0';
+        err                = tb_parse(sig, &T);
+    }
+
+    T.base      = p;
+    T.base_size = (size_t)st.st_size;
+    T.deepest   = p[6];
+    T.blocks    = (size_t)tb_get(p + 20, 4);
+
+    /* The index of the file must be the one of tb_index */
+    if (err == NULL &&
+        (tb_get(T.base + 24, 8) != T.size ||
+         T.blocks != (T.size + TB_BLOCK_SIZE - 1) / TB_BLOCK_SIZE ||
+         T.base_size < TB_HEADER_SIZE + 8 * (T.blocks + 1)))
+        err = TB_ERR_CORRUPT;
+
+    /* Blocks are probed without further bounds checks on the index */
+    prev = TB_HEADER_SIZE + 8 * (T.blocks + 1);
+    for (i = 0; err == NULL && i <= T.blocks; ++i)
+    {
+        cur = (size_t)tb_get(T.base + TB_HEADER_SIZE + 8 * i, 8);
+        if (cur < prev || cur > T.base_size)
+            err = TB_ERR_CORRUPT;
+
+        prev = cur;
+    }
+
+    pthread_mutex_lock(&tb_write_lock);
+    if (err == NULL && tb_find(T.sig) != NULL)
+    {
+        pthread_mutex_unlock(&tb_write_lock);
+        munmap(base, T.base_size);
+        return NULL;
+    }
+
+    if (err == NULL && tb_register(&T) == NULL)
+        err = TB_ERR_FULL;
+    pthread_mutex_unlock(&tb_write_lock);
+
+    if (err != NULL)
+    {
+        munmap(base, T.base_size);
+        return err;
+    }
+
+    posix_madvise(base, T.base_size, POSIX_MADV_RANDOM);
+
+    return NULL;
+}
+
+const char* tb_best_move(board_p B, turn_t turn, move_p M, piece_t* pawn_morph)
+{
+    move16_t       moves[BOARD_MAX_MOVES];
+    struct board_t next;
+    const char*    err;
+    size_t         n;
+    size_t         cur;
+    int            dtm;
+    int            rank;
+    int            best = 0;
+
+    n = board_legal_moves(B, turn, moves, BOARD_MAX_MOVES);
+    if (n == 0)
+        return TB_ERR_NO_MOVE;
+
+    for (cur = 0; cur < n; ++cur)
+    {
+        next = *B;
+        board_exec16(&next, moves[cur]);
+
+        err = tb_probe(&next, (turn_t)~turn, &dtm);
+        if (err != NULL)
+            return err;
+
+        /* From the point of view of turn: mating fast is best, then drawing,
+         * then being mated slowly */
+        if (dtm == TB_DRAW)
+            rank = 0;
+        else if (dtm % 2 == 1)
+            rank = TB_INVALID - dtm;
+        else
+            rank = dtm - TB_INVALID;
+
+        if (cur == 0 || rank > best)
+        {
+            best = rank;
+            move16_unpack(moves[cur], turn, M, pawn_morph);
+        }
+    }
+
+    return NULL;
+}
+
+static void tb_region_init(void)
+{
+    int sq;
+    int row;
+    int col;
+    int n[2] = {0, 0};
+
+    for (sq = 0; sq < 64; ++sq)
+    {
+        row            = sq / 8;
+        col            = sq % 8;
+
+        /* a1-d1-d4 triangle: row 7 is rank 1 */
+        tb_kidx[0][sq] = -1;
+        if (col <= 3 && row >= 4 && row + col >= 7)
+        {
+            tb_ksq[0][n[0]] = sq;
+            tb_kidx[0][sq]  = n[0]++;
+        }
+
+        /* Files a-d */
+        tb_kidx[1][sq] = -1;
+        if (col <= 3)
+        {
+            tb_ksq[1][n[1]] = sq;
+            tb_kidx[1][sq]  = n[1]++;
+        }
+    }
+}
+
+static const char* tb_parse(const char* sig, tb_p T)
+{
+    piece_t     white[TB_MAX_PIECES];
+    piece_t     black[TB_MAX_PIECES];
+    const char* letter;
+    size_t      i;
+    int         nwhite = 0;
+    int         nblack = 0;
+    int         side   = 0;
+    int         k;
+
+    for (; *sig != '\0'; ++sig)
+    {
+        if (*sig == 'v' && side == 0)
+        {
+            side = 1;
+            continue;
+        }
+
+        letter = strchr(TB_LETTERS, *sig);
+        if (letter == NULL || nwhite + nblack == TB_MAX_PIECES)
+            return TB_ERR_SIG;
+
+        if (side == 0)
+            white[nwhite++] = piece_from_char(*letter, cpWTURN);
+        else
+            black[nblack++] = piece_from_char(*letter, cpBTURN);
+    }
+
+    if (side == 0)
+        return TB_ERR_SIG;
+
+    /* Kings first, then the other pieces strongest first */
+    T->npieces = 0;
+    T->pawns   = 0;
+    for (i = 0; TB_LETTERS[i] != '\0'; ++i)
+        for (k = 0; k < nwhite; ++k)
+            if (white[k] == piece_from_char(TB_LETTERS[i], cpWTURN))
+                T->pieces[T->npieces++] = white[k];
+
+    if (T->npieces == 0 || T->pieces[0] != cpWKING ||
+        (T->npieces > 1 && T->pieces[1] == cpWKING))
+        return TB_ERR_SIG;
+
+    k = T->npieces;
+    for (i = 0; TB_LETTERS[i] != '\0'; ++i)
+        for (side = 0; side < nblack; ++side)
+            if (black[side] == piece_from_char(TB_LETTERS[i], cpBTURN))
+                T->pieces[T->npieces++] = black[side];
+
+    if (T->npieces == k || T->pieces[k] != cpBKING ||
+        (T->npieces > k + 1 && T->pieces[k + 1] == cpBKING))
+        return TB_ERR_SIG;
+
+    for (k = 0; k < T->npieces; ++k)
+        T->pawns = T->pawns || T->pieces[k] == cpWPAWN ||
+                   T->pieces[k] == cpBPAWN;
+
+    tb_pieces_sig(T->pieces, T->npieces, T->sig);
+
+    T->kings = T->pawns ? 32 : 10;
+    T->size  = 2 * T->kings;
+    for (k = 1; k < T->npieces; ++k)
+        T->size *= 64;
+
+    T->deepest   = 0;
+    T->dtm       = NULL;
+    T->base      = NULL;
+    T->base_size = 0;
+    T->blocks    = 0;
+
+    return NULL;
+}
+
+static int tb_board_sig(board_p B, char* sig)
+{
+    piece_t    pieces[TB_MAX_PIECES];
+    myuint64_t occupied;
+    int        n = 0;
+
+    for (occupied = ~board_mask(B, cpEEMPTY); occupied != 0;
+         occupied &= occupied - 1)
+    {
+        if (n == TB_MAX_PIECES)
+            return 0;
+
+        pieces[n++] = board_at(B, attack_first(occupied));
+    }
+
+    tb_pieces_sig(pieces, n, sig);
+
+    return 1;
+}
+
+static void tb_pieces_sig(const piece_t* pieces, int n, char* sig)
+{
+    size_t i;
+    int    k;
+    int    side;
+
+    /* Both sides, strongest pieces first: the same material always gives the
+     * same signature */
+    for (side = 0; side < 2; ++side)
+    {
+        if (side == 1)
+            *sig++ = 'v';
+
+        for (i = 0; TB_LETTERS[i] != '\0'; ++i)
+            for (k = 0; k < n; ++k)
+                if (pieces[k] ==
+                    piece_from_char(TB_LETTERS[i], side ? cpBTURN : cpWTURN))
+                    *sig++ = TB_LETTERS[i];
+    }
+
+    *sig = '\0';
+}
+
+static void tb_flip_sig(const char* sig, char* flipped)
+{
+    const char* v = strchr(sig, 'v');
+    size_t      white;
+
+    if (v == NULL)
+    {
+        strcpy(flipped, sig);
+        return;
+    }
+
+    white = (size_t)(v - sig);
+    strcpy(flipped, v + 1);
+    strcat(flipped, "v");
+    strncat(flipped, sig, white);
+}
+
+static void tb_flip_board(board_p B, board_p F)
+{
+    int sq;
+
+    board_clear(F);
+    for (sq = 0; sq < 64; ++sq)
+        board_put(F, 8 * (7 - sq / 8) + sq % 8, (piece_t)-board_at(B, sq));
+
+    F->wking.row = (myint8_t)(7 - B->bking.row);
+    F->wking.col = B->bking.col;
+    F->bking.row = (myint8_t)(7 - B->wking.row);
+    F->bking.col = B->wking.col;
+
+    board_index(F);
+}
+
+static tb_p tb_find(const char* sig)
+{
+    tb_p   T = NULL;
+    size_t i;
+
+    pthread_rwlock_rdlock(&tb_registry_lock);
+    for (i = 0; T == NULL && i < tb_count; ++i)
+        if (strcmp(tb_tables[i]->sig, sig) == 0)
+            T = tb_tables[i];
+    pthread_rwlock_unlock(&tb_registry_lock);
+
+    return T;
+}
+
+static int tb_transform(int sq, int t)
+{
+    int row = sq / 8;
+    int col = sq % 8;
+    int tmp;
+
+    if (t & 1)
+        col = 7 - col;
+
+    if (t & 2)
+        row = 7 - row;
+
+    /* Reflection on the a1-h8 diagonal */
+    if (t & 4)
+    {
+        tmp = row;
+        row = 7 - col;
+        col = 7 - tmp;
+    }
+
+    return 8 * row + col;
+}
+
+static size_t tb_index(tb_p T, board_p B, turn_t turn)
+{
+    myuint64_t used = 0;
+    myuint64_t cand;
+    int        sq[TB_MAX_PIECES];
+    int        kidx = -1;
+    int        t;
+    int        i;
+    size_t     idx;
+
+    /* Each piece on the first square holding it that is not taken yet */
+    for (i = 0; i < T->npieces; ++i)
+    {
+        cand = board_mask(B, T->pieces[i]) & ~used;
+        if (cand == 0)
+            return T->size;
+
+        sq[i] = attack_first(cand);
+        used |= attack_bit(sq[i]);
+    }
+
+    for (t = 0; t < (T->pawns ? 2 : 8) && kidx == -1; ++t)
+        kidx = tb_kidx[T->pawns][tb_transform(sq[0], t)];
+    --t;
+
+    idx = (turn == cpWTURN ? 0 : T->kings) + (size_t)kidx;
+    for (i = 1; i < T->npieces; ++i)
+        idx = idx * 64 + (size_t)tb_transform(sq[i], t);
+
+    return idx;
+}
+
+static int tb_decode(tb_p T, size_t idx, board_p B, turn_t* turn)
+{
+    struct coord_t whence;
+    int            sq[TB_MAX_PIECES];
+    int            i;
+
+    for (i = T->npieces - 1; i > 0; --i)
+    {
+        sq[i] = (int)(idx % 64);
+        idx /= 64;
+    }
+
+    sq[0] = tb_ksq[T->pawns][idx % T->kings];
+    *turn = idx / T->kings == 0 ? cpWTURN : cpBTURN;
+
+    board_clear(B);
+
+    for (i = 0; i < T->npieces; ++i)
+    {
+        if (board_at(B, sq[i]) != cpEEMPTY)
+            return 0;
+
+        if ((T->pieces[i] == cpWPAWN || T->pieces[i] == cpBPAWN) &&
+            (sq[i] < 8 || sq[i] >= 56))
+            return 0;
+
+        board_put(B, sq[i], T->pieces[i]);
+
+        if (T->pieces[i] == cpWKING || T->pieces[i] == cpBKING)
+        {
+            whence.row = (myint8_t)(sq[i] / 8);
+            whence.col = (myint8_t)(sq[i] % 8);
+
+            if (T->pieces[i] == cpWKING)
+                B->wking = whence;
+            else
+                B->bking = whence;
+        }
+    }
+
+    board_index(B);
+
+    /* The side that has just moved cannot be in check */
+    whence.row = whence.col = -1;
+    board_under_check_part(
+        B, *turn == cpWTURN ? &B->bking : &B->wking, &whence
+    );
+
+    return whence.row == -1;
+}
+
+static const char* tb_build(tb_p T, unsigned int nthreads)
+{
+    piece_t     sub[TB_MAX_PIECES];
+    const char* err;
+    const char* promotion;
+    size_t      changed;
+    size_t      i;
+    int         depth;
+    int         deepest;
+    int         k;
+
+    /* Tables reached by a capture: kings cannot be captured */
+    for (k = 1; k < T->npieces; ++k)
+    {
+        if (T->pieces[k] == cpBKING)
+            continue;
+
+        memcpy(sub, T->pieces, sizeof(sub));
+        sub[k] = sub[T->npieces - 1];
+
+        err    = tb_build_sub(sub, T->npieces - 1, nthreads);
+        if (err != NULL)
+            return err;
+    }
+
+    /* Tables reached by a promotion */
+    for (k = 1; k < T->npieces; ++k)
+    {
+        if (T->pieces[k] != cpWPAWN && T->pieces[k] != cpBPAWN)
+            continue;
+
+        for (promotion = "QRBN"; *promotion != '\0'; ++promotion)
+        {
+            memcpy(sub, T->pieces, sizeof(sub));
+            sub[k] = piece_from_char(
+                *promotion, T->pieces[k] > 0 ? cpWTURN : cpBTURN
+            );
+
+            err = tb_build_sub(sub, T->npieces, nthreads);
+            if (err != NULL)
+                return err;
+        }
+    }
+
+    if (tb_count == TB_MAX_TABLES)
+        return TB_ERR_FULL;
+
+    T->dtm = calloc(T->size, 1);
+    if (T->dtm == NULL)
+        return TB_ERR_MEMORY;
+
+    /* Values of other tables are known from the start: passes cannot stop
+     * before the deepest of them has been taken into account */
+    for (deepest = 0, i = 0; i < tb_count; ++i)
+        if (tb_tables[i]->deepest > deepest)
+            deepest = tb_tables[i]->deepest;
+
+    /* Pass 0 finds invalid positions and checkmates; pass n finds the
+     * positions that are n plies from mate */
+    tb_run_pass(T, 0, nthreads);
+    for (depth = 1; depth < TB_INVALID - 1; ++depth)
+    {
+        changed = tb_run_pass(T, depth, nthreads);
+        if (changed == 0 && depth >= deepest)
+            break;
+    }
+
+    for (i = 0; i < T->size; ++i)
+        if (T->dtm[i] != TB_INVALID && T->dtm[i] > T->deepest)
+            T->deepest = T->dtm[i];
+
+    if (tb_register(T) == NULL)
+    {
+        free(T->dtm);
+        T->dtm = NULL;
+        return TB_ERR_MEMORY;
+    }
+
+    return NULL;
+}
+
+static const char*
+tb_build_sub(const piece_t* pieces, int n, unsigned int nthreads)
+{
+    struct tb_t S;
+    char        sig[TB_SIG_LENGTH];
+    char        flipped[TB_SIG_LENGTH];
+    const char* err;
+
+    tb_pieces_sig(pieces, n, sig);
+    tb_flip_sig(sig, flipped);
+
+    if (tb_find(sig) != NULL || tb_find(flipped) != NULL)
+        return NULL;
+
+    err = tb_parse(sig, &S);
+    if (err != NULL)
+        return err;
+
+    return tb_build(&S, nthreads);
+}
+
+static size_t tb_run_pass(tb_p T, int depth, unsigned int nthreads)
+{
+    struct tb_pass_t whole;
+    tb_pass_p        P;
+    pthread_t*       threads;
+    size_t           changed;
+    unsigned int     i;
+
+    whole.T       = T;
+    whole.depth   = depth;
+    whole.begin   = 0;
+    whole.end     = T->size;
+    whole.started = 0;
+
+    P           = malloc(nthreads * sizeof(struct tb_pass_t));
+    threads     = malloc(nthreads * sizeof(pthread_t));
+
+    /* Not worth failing for: run the pass in this thread */
+    if (nthreads < 2 || P == NULL || threads == NULL)
+    {
+        free(P);
+        free(threads);
+        tb_pass(&whole);
+        return whole.changed;
+    }
+
+    for (i = 0; i < nthreads; ++i)
+    {
+        P[i]       = whole;
+        P[i].begin = T->size / nthreads * i;
+        P[i].end   = i + 1 == nthreads ? T->size : T->size / nthreads * (i + 1);
+        P[i].started = pthread_create(threads + i, NULL, tb_pass, P + i) == 0;
+
+        /* The slice is not left out: this thread works it instead */
+        if (!P[i].started)
+            tb_pass(P + i);
+    }
+
+    for (changed = 0, i = 0; i < nthreads; ++i)
+    {
+        if (P[i].started)
+            pthread_join(threads[i], NULL);
+        changed += P[i].changed;
+    }
+
+    free(P);
+    free(threads);
+
+    return changed;
+}
+
+/* Positions of the same table are read and written by every thread of a
+ * pass: accesses are atomic (relaxed, the value only has to be read whole).
+ * Whether a value written during pass n is seen or not by another thread of
+ * the same pass does not change the outcome: pass n only looks for values
+ * set by pass n - 1 */
+static void* tb_pass(void* arg)
+{
+    tb_pass_p      P = arg;
+    tb_p           T = P->T;
+    struct board_t B;
+    struct board_t next;
+    move16_t       M[BOARD_MAX_MOVES];
+    struct coord_t whence;
+    turn_t         turn;
+    size_t         idx;
+    size_t         n;
+    size_t         cur;
+    int            value;
+    int            fastest; /* Successor mated the fastest */
+    int            slowest; /* Successor mating the slowest */
+    int            all_won; /* Every successor mates */
+
+    P->changed = 0;
+
+    for (idx = P->begin; idx < P->end; ++idx)
+    {
+        if (__atomic_load_n(T->dtm + idx, __ATOMIC_RELAXED) != TB_DRAW)
+            continue;
+
+        if (!tb_decode(T, idx, &B, &turn))
+        {
+            __atomic_store_n(T->dtm + idx, TB_INVALID, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        n = board_legal_moves(&B, turn, M, BOARD_MAX_MOVES);
+
+        if (n == 0)
+        {
+            /* Checkmate, or stalemate (a draw) */
+            whence.row = whence.col = -1;
+            board_under_check_part(
+                &B, turn == cpWTURN ? &B.wking : &B.bking, &whence
+            );
+            if (P->depth == 0 && whence.row != -1)
+            {
+                __atomic_store_n(T->dtm + idx, 1, __ATOMIC_RELAXED);
+                ++P->changed;
+            }
+
+            continue;
+        }
+
+        if (P->depth == 0)
+            continue;
+
+        fastest = TB_INVALID;
+        slowest = 0;
+        all_won = 1;
+
+        for (cur = 0; cur < n; ++cur)
+        {
+            next = B;
+            board_exec16(&next, M[cur]);
+
+            /* Captures and promotions lead to another table */
+            if (!move16_is_capture(M[cur]) && move16_morph(M[cur]) == cpEEMPTY)
+                value = __atomic_load_n(
+                    T->dtm + tb_index(T, &next, (turn_t)~turn),
+                    __ATOMIC_RELAXED
+                );
+            else if (tb_probe(&next, (turn_t)~turn, &value) != NULL)
+                value = TB_DRAW;
+
+            if (value == TB_DRAW)
+                all_won = 0;
+            else if (value % 2 == 1 && value < fastest)
+                fastest = value;
+            else if (value % 2 == 0 && value > slowest)
+                slowest = value;
+        }
+
+        if (fastest == P->depth ||
+            (all_won && fastest == TB_INVALID && slowest == P->depth))
+        {
+            __atomic_store_n(
+                T->dtm + idx, (myuint8_t)(P->depth + 1), __ATOMIC_RELAXED
+            );
+            ++P->changed;
+        }
+    }
+
+    return NULL;
+}
+
+static int tb_value(tb_p T, size_t idx)
+{
+    tb_cache_p C   = tb_cache;
+    tb_cache_p lru = tb_cache;
+    size_t     block;
+    int        value;
+
+    if (T->dtm != NULL)
+        return T->dtm[idx];
+
+    block = idx / TB_BLOCK_SIZE;
+
+    pthread_mutex_lock(&tb_cache_lock);
+
+    for (; C < tb_cache + TB_CACHE_BLOCKS; ++C)
+    {
+        if (C->T == T && C->block == block)
+            break;
+
+        if (C->used < lru->used)
+            lru = C;
+    }
+
+    if (C == tb_cache + TB_CACHE_BLOCKS)
+    {
+        C        = lru;
+        C->T     = T;
+        C->block = block;
+
+        if (!tb_inflate(T, block, C->data))
+            C->T = NULL;
+    }
+
+    C->used = ++tb_cache_clock;
+    value   = C->T == NULL ? -1 : C->data[idx % TB_BLOCK_SIZE];
+
+    pthread_mutex_unlock(&tb_cache_lock);
+
+    return value;
+}
+
+static int tb_inflate(tb_p T, size_t block, myuint8_t* data)
+{
+    const myuint8_t* index = T->base + TB_HEADER_SIZE + 8 * block;
+    const myuint8_t* p     = T->base + tb_get(index, 8);
+    const myuint8_t* end   = T->base + tb_get(index + 8, 8);
+    size_t           n;
+    size_t           have = 0;
+    size_t           len;
+
+    n = block + 1 == T->blocks ? T->size - block * TB_BLOCK_SIZE
+                               : TB_BLOCK_SIZE;
+
+    while (p < end)
+    {
+        if (*p < 128)
+        {
+            len = (size_t)*p++ + 1;
+            if ((size_t)(end - p) < len || have + len > n)
+                return 0;
+
+            memcpy(data + have, p, len);
+            p += len;
+        }
+        else
+        {
+            len = (size_t)*p++ - 125;
+            if (p == end || have + len > n)
+                return 0;
+
+            memset(data + have, *p++, len);
+        }
+
+        have += len;
+    }
+
+    return have == n;
+}
+
+static size_t tb_deflate(const myuint8_t* data, size_t n, myuint8_t* out)
+{
+    size_t i = 0;
+    size_t start;
+    size_t run;
+    size_t len = 0;
+
+    while (i < n)
+    {
+        for (run = 1; i + run < n && run < 130 && data[i + run] == data[i];
+             ++run)
+            ;
+
+        if (run >= 3)
+        {
+            out[len++] = (myuint8_t)(run + 125);
+            out[len++] = data[i];
+            i += run;
+            continue;
+        }
+
+        /* Literals, up to the next run */
+        for (start = i; i < n && i - start < 128; ++i)
+            if (i + 2 < n && data[i] == data[i + 1] && data[i] == data[i + 2])
+                break;
+
+        out[len++] = (myuint8_t)(i - start - 1);
+        memcpy(out + len, data + start, i - start);
+        len += i - start;
+    }
+
+    return len;
+}
+
+static tb_p tb_register(tb_p T)
+{
+    tb_p R;
+
+    if (tb_count == TB_MAX_TABLES)
+        return NULL;
+
+    R = malloc(sizeof(struct tb_t));
+    if (R == NULL)
+        return NULL;
+
+    *R = *T;
+
+    pthread_rwlock_wrlock(&tb_registry_lock);
+    tb_tables[tb_count++] = R;
+    pthread_rwlock_unlock(&tb_registry_lock);
+
+    return R;
+}
+
+static void tb_put(myuint8_t* p, unsigned long v, int bytes)
+{
+    while (bytes-- > 0)
+    {
+        p[bytes] = (myuint8_t)(v & 0xFF);
+        v >>= 8;
+    }
+}
+
+static unsigned long tb_get(const myuint8_t* p, int bytes)
+{
+    unsigned long v = 0;
+    int           i;
+
+    for (i = 0; i < bytes; ++i)
+        v = v << 8 | p[i];
+
+    return v;
+}
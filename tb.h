@@ -0,0 +1,131 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_TB_H
+#define CMC_CHESS_TB_H
+
+#include <stddef.h>
+
+#include "board.h"
+#include "int.h"
+#include "move.h"
+#include "piece.h"
+
+/* Endgame tablebases.
+ *
+ * A table holds the depth to mate of every position of a material signature
+ * such as "KQvK" (white pieces, 'v', black pieces; kings included, at most
+ * TB_MAX_PIECES pieces), for both sides to move. Tables are generated in
+ * memory by retrograde analysis, with the move semantics of board.c: kings
+ * cannot capture, there is no castling nor en passant.
+ *
+ * Positions are stored one byte each (see tb_probe) and indexed by the
+ * squares of the pieces, the white king being restricted by symmetry: to the
+ * a1-d1-d4 triangle without pawns (8 symmetries), to files a-d with pawns
+ * (left-right symmetry only).
+ *
+ * Tables are immutable once generated or loaded: probes can run
+ * concurrently, also with tb_generate and tb_load, which run one at a time.
+ *
+ * The registry of tables and the block cache are process wide on purpose:
+ * tables are large and read only, so every game of the process probes the
+ * same ones (see server.h). They are the only mutable state a game does not
+ * own, and they are locked (see tb.c).
+ */
+
+/* Table File Layout
+ *
+ * Every multi-byte field is stored big-endian.
+ *
+ * Header (TB_HEADER_SIZE bytes):
+ * - 0..3:   magic "CMCT";
+ * - 4:      format version;
+ * - 5:      compression (1: run-length);
+ * - 6:      largest value of the table, TB_INVALID excluded;
+ * - 7:      reserved, zero;
+ * - 8..15:  signature, NUL padded;
+ * - 16..19: positions per block (TB_BLOCK_SIZE);
+ * - 20..23: number of blocks;
+ * - 24..31: number of positions.
+ *
+ * Block index: one offset from the beginning of the file (8 bytes) per
+ * block, plus the offset of the end of the last block.
+ *
+ * Blocks: the values of TB_BLOCK_SIZE consecutive positions (fewer for the
+ * last block), run-length encoded: a byte c < 128 is followed by c + 1
+ * values, a byte c >= 128 by one value repeated c - 125 times.
+ *
+ * Loaded tables are mapped in memory; a probe decompresses the block of the
+ * position into a cache of the TB_CACHE_BLOCKS most recently used blocks,
+ * shared by all tables and threads.
+ */
+#define TB_HEADER_SIZE 32
+#define TB_BLOCK_SIZE 65536
+#define TB_CACHE_BLOCKS 32
+
+#define TB_MAX_PIECES 4
+
+/* Longest signature, NUL terminator included */
+#define TB_SIG_LENGTH 8
+
+/* Probe values */
+#define TB_DRAW 0
+#define TB_INVALID 255
+
+extern const char* TB_ERR_SIG;
+extern const char* TB_ERR_MEMORY;
+extern const char* TB_ERR_FULL;
+extern const char* TB_ERR_MISSING;
+extern const char* TB_ERR_NO_MOVE;
+extern const char* TB_ERR_OPEN;
+extern const char* TB_ERR_MAP;
+extern const char* TB_ERR_MAGIC;
+extern const char* TB_ERR_VERSION;
+extern const char* TB_ERR_CORRUPT;
+
+/* Generate the table of the signature sig and, first, every table it can
+ * turn into by a capture or a promotion. Tables that already exist are not
+ * generated again. Passes are split among nthreads threads (one per CPU if
+ * nthreads is 0).
+ *
+ * RETURN
+ * NULL on success, TB_ERR_* otherwise.
+ */
+extern const char* tb_generate(const char* sig, unsigned int nthreads);
+
+/* Write the table of the signature sig (generated or loaded) to fname.
+ *
+ * RETURN
+ * NULL on success, TB_ERR_* otherwise.
+ */
+extern const char* tb_save(const char* sig, const char* fname);
+
+/* Map the table file fname in memory and make it available to probes. Does
+ * nothing if a table of the same signature is already available.
+ *
+ * RETURN
+ * NULL on success, TB_ERR_* otherwise.
+ */
+extern const char* tb_load(const char* fname);
+
+/* Look B up, turn being the side to move. A table with the colours swapped
+ * is used if needed.
+ *
+ * *dtm is set to TB_DRAW, or to the number of plies to mate plus one: even
+ * if the side to move mates, odd if it is mated (1 means it is checkmate).
+ *
+ * RETURN
+ * NULL on success, TB_ERR_* otherwise.
+ */
+extern const char* tb_probe(board_p B, turn_t turn, int* dtm);
+
+/* Set M and pawn_morph to the best move of turn: the fastest mate when
+ * winning, the slowest when losing, a move keeping the draw otherwise.
+ *
+ * RETURN
+ * NULL on success, TB_ERR_* otherwise.
+ */
+extern const char*
+tb_best_move(board_p B, turn_t turn, move_p M, piece_t* pawn_morph);
+
+#endif /* CMC_CHESS_TB_H */
@@ -0,0 +1,28 @@
+#!/bin/bash
+
+fixtures="$(dirname "$0")/fixtures"
+
+# Timings are dropped, results are sorted: workers finish in any order
+run() {
+	./cmc-chess epd-perft "$@" | sed -e 's/ (.* ms)$//' -e 's/ in .*$//' | sort
+	return "${PIPESTATUS[0]}"
+}
+
+out=$(run "$fixtures/perft.epd" 2) || exit 1
+diff - <(echo "$out") <<'END' || exit 1
+2 positions, 0 failed, 9991 nodes
+2: ok 9322 nodes
+4: ok 669 nodes
+END
+
+# A wrong count is reported and fails the run
+out=$(run "$fixtures/perft_wrong.epd" 1) && exit 1
+diff - <(echo "$out") <<'END' || exit 1
+1 positions, 1 failed, 420 nodes
+1: FAIL D2 400, expected 401
+END
+
+# So does a missing file
+./cmc-chess epd-perft "$fixtures/missing.epd" 2> /dev/null && exit 1
+
+exit 0
@@ -0,0 +1,27 @@
+#!/bin/bash
+
+fixtures="$(dirname "$0")/fixtures"
+
+# Timings are dropped, results are sorted: workers finish in any order
+run() {
+	./cmc-chess pgn-check "$@" | sed -e 's/ in .*$//' | sort
+	return "${PIPESTATUS[0]}"
+}
+
+# The second game has an illegal king move, games 4 to 9 misuse the capture
+# marker or a disambiguation; the others replay to the end
+out=$(run "$fixtures/games.pgn" 2) && exit 1
+diff - <(echo "$out") <<'END' || exit 1
+10 games, 7 failed, 45 moves
+game 2 (line 8): 2. Ke3: illegal move
+game 4 (line 20): 2. d5: illegal move
+game 5 (line 25): 2... Nxc6: illegal move
+game 6 (line 30): 2. ed5: not a SAN move
+game 7 (line 35): 2. xd5: not a SAN move
+game 8 (line 40): 2... Qd5: illegal move
+game 9 (line 45): 4. Nb5: ambiguous move
+END
+
+./cmc-chess pgn-check "$fixtures/missing.pgn" 2> /dev/null && exit 1
+
+exit 0
@@ -0,0 +1,35 @@
+#!/bin/bash
+
+set -o pipefail
+
+book=$(mktemp) || exit 1
+trap 'rm -f "$book"' EXIT
+
+# One Polyglot entry: the start position (key 463b96181691fc9c), e2e4 with
+# weight 10
+printf '\x46\x3b\x96\x18\x16\x91\xfc\x9c\x03\x1c\x00\x0a\x00\x00\x00\x00' \
+	> "$book"
+
+# Only the messages are kept, the board is dropped
+out=$(./cmc-chess <<END | grep -v -e $'\e' -e '^It is' -e '^ *A B C' -e '^$'
+?book
+.book $book
+?book
+.bookmove
+=assert piece-is src=E4 piece=1
+?book
+.bookmove
+quit
+END
+) || exit 1
+
+diff - <(echo "$out") <<'END' || exit 1
+no book: see .book
+book opened
+E2E4 10 (100%)
+position not in book
+no book move
+Command: Bye
+END
+
+exit 0
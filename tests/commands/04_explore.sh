@@ -0,0 +1,55 @@
+#!/bin/bash
+
+set -o pipefail
+
+fixtures="$(dirname "$0")/fixtures"
+
+index=$(mktemp) || exit 1
+trap 'rm -f "$index"' EXIT
+
+# Six games: the fourth without a result, the fifth indexed up to its castle
+# (its result is only in the termination marker), the last one illegal from
+# the first move. 10 distinct position/move pairs.
+out=$(./cmc-chess build-index "$index" "$fixtures/openings.pgn" 2 |
+	sed -e 's/ in .*$//') || exit 1
+[ "$out" = "6 games, 1 truncated, 1 skipped, 10 entries" ] || exit 1
+
+# Only the messages are kept, the board is dropped
+out=$(./cmc-chess <<END | grep -v -e $'\e' -e '^It is' -e '^ *A B C' -e '^$'
+?explore
+.explore $index
+?explore
+e2e4
+?explore
+e7e5
+?explore
+g1f3
+?explore
+b8c6
+?explore
+f1c4
+?explore
+f8c5
+?explore
+quit
+END
+) || exit 1
+
+diff - <(echo "$out") <<'END' || exit 1
+no index: see .explore
+index opened
+D2D4 1 games: 0 white, 0 draw, 1 black
+E2E4 4 games: 2 white, 1 draw, 0 black
+C7C5 1 games: 0 white, 1 draw, 0 black
+E7E5 3 games: 2 white, 0 draw, 0 black
+G1F3 3 games: 2 white, 0 draw, 0 black
+B8C6 2 games: 1 white, 0 draw, 0 black
+F1C4 1 games: 1 white, 0 draw, 0 black
+F8C5 1 games: 1 white, 0 draw, 0 black
+position not in index
+Command: Bye
+END
+
+./cmc-chess build-index "$index" "$fixtures/missing.pgn" 2> /dev/null && exit 1
+
+exit 0
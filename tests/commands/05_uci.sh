@@ -0,0 +1,60 @@
+#!/bin/bash
+
+# The engine runs as a coprocess: go answers asynchronously, so every step
+# reads the replies up to the line it ends with before the next one is sent
+coproc UCI { ./cmc-chess uci; }
+pid=$UCI_PID
+
+out=
+
+# Send $1, then collect the replies up to the first one starting with $2 (none
+# if $2 is empty); timings are dropped from info lines
+step() {
+	local line
+
+	echo "$1" >&"${UCI[1]}"
+	[ -n "$2" ] || return 0
+	while read -r -t 10 line <&"${UCI[0]}"; do
+		out+="$(echo "$line" | sed -e 's/ time .* pv / pv /')"$'\n'
+		case "$line" in "$2"*) return 0 ;; esac
+	done
+	return 1
+}
+
+step "uci" "uciok" || exit 1
+
+# Ponder is accepted silently, unknown options are not
+step "setoption name Ponder value true" "" || exit 1
+step "isready" "readyok" || exit 1
+step "setoption name Bogus value 1" "info string" || exit 1
+
+step "position startpos moves e2e4 e7e5 g1f3" "" || exit 1
+step "go depth 5" "bestmove" || exit 1
+
+# A list with an illegal move leaves the position as it was: black to move
+step "position startpos moves e2e4 e7e5 e7e5" "info string" || exit 1
+step "go depth 1" "bestmove" || exit 1
+
+echo "quit" >&"${UCI[1]}"
+wait "$pid" || exit 1
+
+diff - <(echo -n "$out") <<'END' || exit 1
+id name cmc-chess
+id author Mattia Cabrini
+option name Depth type spin default 5 min 1 max 64
+option name Ponder type check default false
+uciok
+readyok
+info string unknown option
+info depth 1 score cp 1 nodes 55 pv d7d6
+info depth 2 score cp -1 nodes 242 pv d7d6
+info depth 3 score cp 0 nodes 2518 pv d8e7
+info depth 4 score cp -1 nodes 21101 pv d7d6
+info depth 5 score cp 1 nodes 131476 pv d7d6
+bestmove d7d6
+info string illegal move e7e5: source is empty
+info depth 1 score cp 1 nodes 55 pv d7d6
+bestmove d7d6
+END
+
+exit 0
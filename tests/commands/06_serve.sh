@@ -0,0 +1,65 @@
+#!/bin/bash
+
+# The client needs python3: skipped without it (see SKIP_RETURN_CODE)
+command -v python3 > /dev/null || exit 77
+
+dir=$(mktemp -d) || exit 1
+./cmc-chess serve "$dir/sock" 2 > /dev/null &
+server=$!
+trap 'kill "$server"; rm -rf "$dir"' EXIT
+
+for i in $(seq 50); do
+	[ -S "$dir/sock" ] && break
+	sleep 0.1
+done
+
+# Three sessions: the first two are open together and must not share their
+# game, the third one is dropped by a failed assertion. Only the messages
+# are kept, the boards are dropped.
+out=$(python3 - "$dir/sock" <<'END'
+import socket
+import sys
+
+def session(path):
+    s = socket.socket(socket.AF_UNIX)
+    s.connect(path)
+    return s
+
+def talk(s, commands):
+    s.sendall(commands.encode())
+    s.shutdown(socket.SHUT_WR)
+    data = b""
+    while True:
+        chunk = s.recv(4096)
+        if not chunk:
+            break
+        data += chunk
+    for line in data.decode().split("\n"):
+        if "\x1b" in line or line.startswith("It is") or \
+                line.strip() in ("", "A B C D E F G H", "Command:"):
+            continue
+        print(line)
+    print("--")
+
+a = session(sys.argv[1])
+b = session(sys.argv[1])
+talk(a, "e2e4\n.tbgen KQvK\n=assert piece-is src=E4 piece=1\nquit\n")
+talk(b, "=assert piece-is src=E2 piece=1\nquit\n")
+talk(session(sys.argv[1]), "=assert piece-is src=E4 piece=1\nquit\n")
+END
+) || exit 1
+
+diff - <(echo "$out") <<'END' || exit 1
+not available in server sessions
+Command: Bye
+--
+Command: Bye
+--
+Command: Error: assert failed.
+--
+END
+
+# The server outlives its sessions
+kill -0 "$server" || exit 1
+
+exit 0
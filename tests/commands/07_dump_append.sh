@@ -0,0 +1,38 @@
+#!/bin/bash
+
+set -o pipefail
+
+dir=$(mktemp -d) || exit 1
+trap 'rm -rf "$dir"' EXIT
+
+# Runs the REPL on commands given as arguments, keeping only the messages
+repl()
+{
+    printf '%s\n' "$@" quit | ./cmc-chess |
+        grep -v -e $'\e' -e '^It is' -e '^ *A B C' -e '^$'
+}
+
+# A dump of two records, a foreign file and a dump cut inside its second record
+out=$(repl ".dump $dir/ok" ".dump+ $dir/ok") || exit 1
+[ "$(wc -c < "$dir/ok")" -eq 80 ] || exit 1
+printf 'garbage!' > "$dir/foreign"
+head -c 60 "$dir/ok" > "$dir/cut"
+cp "$dir/foreign" "$dir/foreign.orig"
+cp "$dir/cut" "$dir/cut.orig"
+
+out=$(repl ".dump+ $dir/foreign") || exit 1
+[ "$out" = "could not dump: not a cmc-chess dump
+Command: Bye" ] || exit 1
+cmp -s "$dir/foreign" "$dir/foreign.orig" || exit 1
+
+out=$(repl ".dump+ $dir/cut") || exit 1
+[ "$out" = "could not dump: archive is truncated
+Command: Bye" ] || exit 1
+cmp -s "$dir/cut" "$dir/cut.orig" || exit 1
+
+# A whole dump grows by one record, a missing one gets a header first
+out=$(repl ".dump+ $dir/ok" ".dump+ $dir/new") || exit 1
+[ "$(wc -c < "$dir/ok")" -eq 116 ] || exit 1
+[ "$(wc -c < "$dir/new")" -eq 44 ] || exit 1
+
+exit 0
@@ -0,0 +1,487 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+/* Write the attack and geometry tables of attack.h as a C source file.
+ *
+ * Usage: attack-gen FILE [pext]
+ *
+ * With pext, the attack sets are laid out for builds with -DPEXT (and no
+ * magic number is searched); the file does not compile otherwise, nor does
+ * a file generated without pext compile with -DPEXT.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "attack.h"
+#include "exit_codes.h"
+
+/* Relevant squares of a rook in a corner: the most of any slider */
+#define ATTACK_GEN_MAX_BITS 12
+
+/* The two 32 bit halves of a 64 bit value, as printf arguments for
+ * "0x%08lx%08lx": long may be 32 bit */
+#define ATTACK_GEN_HALVES(v)                                                   \
+    (unsigned long)((v) >> 32), (unsigned long)((v) & 0xFFFFFFFFUL)
+
+static const int ATTACK_GEN_ROOK_DIRS[4][2] = {
+    {1, 0}, {-1, 0}, {0, 1}, {0, -1}
+};
+static const int ATTACK_GEN_BISHOP_DIRS[4][2] = {
+    {1, 1}, {1, -1}, {-1, 1}, {-1, -1}
+};
+static const int ATTACK_GEN_KNIGHT_STEPS[8][2] = {
+    {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}
+};
+static const int ATTACK_GEN_KING_STEPS[8][2] = {
+    {-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}
+};
+
+/* White pawns go towards row 0, black ones towards row 7 */
+static const int ATTACK_GEN_PAWN_STEPS[2][2][2] = {
+    {{-1, -1}, {-1, 1}}, {{1, -1}, {1, 1}}
+};
+
+static struct attack_magic_t attack_gen_rooks[64];
+static struct attack_magic_t attack_gen_bishops[64];
+static myuint64_t            attack_gen_table[ATTACK_ENTRIES];
+static myuint64_t            attack_gen_knights[64];
+static myuint64_t            attack_gen_kings[64];
+static myuint64_t            attack_gen_pawns[2][64];
+static myuint64_t            attack_gen_between[64][64];
+static myuint64_t            attack_gen_line[64][64];
+static myuint8_t             attack_gen_distance[64][64];
+
+static myuint32_t attack_gen_slider(
+    attack_magic_p M, int sq, const int (*dirs)[2], myuint32_t offset,
+    int pext, myuint64_t* seed
+);
+static int attack_gen_magic(
+    attack_magic_p M, const myuint64_t* occupied, const myuint64_t* attacks,
+    int n, myuint64_t* seed
+);
+static myuint64_t
+attack_gen_slide(int sq, const int (*dirs)[2], myuint64_t occupied, int edges);
+static size_t attack_gen_index(attack_magic_p M, myuint64_t occupied, int pext);
+static myuint64_t attack_gen_leaper(int sq, const int (*steps)[2], int n);
+static void       attack_gen_geometry(int a, int b);
+static int        attack_gen_sign(int x);
+static myuint64_t attack_gen_bit(int sq);
+static int        attack_gen_count(myuint64_t bb);
+static myuint64_t attack_gen_random(myuint64_t* seed);
+static void
+attack_gen_write_magics(FILE* fp, const char* name, attack_magic_p M);
+static void attack_gen_write_bitboards(
+    FILE* fp, const char* decl, const myuint64_t* bb, int rows, int cols
+);
+static void attack_gen_write_distance(FILE* fp);
+
+int main(int argc, char** argv)
+{
+    /* Any seed works */
+    myuint64_t seed = MYUINT64_C(0x2545F4914F6CDD1D);
+    myuint32_t offset;
+    FILE*      fp;
+    int        pext;
+    int        sq;
+    int        to;
+
+    pext = argc == 3 && strcmp(argv[2], "pext") == 0;
+    if (argc != 2 && !pext)
+    {
+        fprintf(stderr, "Usage: %s FILE [pext]\n", argv[0]);
+        return CHESS_COMMAND_BAD_ARGS;
+    }
+
+    offset = 0;
+    for (sq = 0; sq < 64; ++sq)
+        offset = attack_gen_slider(
+            attack_gen_rooks + sq,
+            sq,
+            ATTACK_GEN_ROOK_DIRS,
+            offset,
+            pext,
+            &seed
+        );
+
+    for (sq = 0; sq < 64; ++sq)
+        offset = attack_gen_slider(
+            attack_gen_bishops + sq,
+            sq,
+            ATTACK_GEN_BISHOP_DIRS,
+            offset,
+            pext,
+            &seed
+        );
+
+    for (sq = 0; sq < 64; ++sq)
+    {
+        attack_gen_knights[sq] =
+            attack_gen_leaper(sq, ATTACK_GEN_KNIGHT_STEPS, 8);
+        attack_gen_kings[sq] = attack_gen_leaper(sq, ATTACK_GEN_KING_STEPS, 8);
+        attack_gen_pawns[0][sq] =
+            attack_gen_leaper(sq, ATTACK_GEN_PAWN_STEPS[0], 2);
+        attack_gen_pawns[1][sq] =
+            attack_gen_leaper(sq, ATTACK_GEN_PAWN_STEPS[1], 2);
+
+        for (to = 0; to < 64; ++to)
+            attack_gen_geometry(sq, to);
+    }
+
+    fp = fopen(argv[1], "w");
+    if (fp == NULL)
+    {
+        perror(argv[1]);
+        return CHESS_FILE_ERROR;
+    }
+
+    fprintf(fp, "/* Generated by tools/attack_gen.c: do not edit */\n\n");
+    fprintf(fp, "#include \"attack.h\"\n\n");
+    fprintf(fp, pext ? "#ifndef PEXT\n" : "#ifdef PEXT\n");
+    fprintf(
+        fp,
+        "#error \"attack tables generated %s pext\"\n",
+        pext ? "with" : "without"
+    );
+    fprintf(fp, "#endif\n\n");
+
+    attack_gen_write_magics(fp, "attack_rooks", attack_gen_rooks);
+    attack_gen_write_magics(fp, "attack_bishops", attack_gen_bishops);
+
+    attack_gen_write_bitboards(
+        fp,
+        "const myuint64_t attack_table[ATTACK_ENTRIES]",
+        attack_gen_table,
+        1,
+        ATTACK_ENTRIES
+    );
+    attack_gen_write_bitboards(
+        fp, "const myuint64_t attack_knights[64]", attack_gen_knights, 1, 64
+    );
+    attack_gen_write_bitboards(
+        fp, "const myuint64_t attack_kings[64]", attack_gen_kings, 1, 64
+    );
+    attack_gen_write_bitboards(
+        fp, "const myuint64_t attack_pawns[2][64]", attack_gen_pawns[0], 2, 64
+    );
+    attack_gen_write_bitboards(
+        fp,
+        "const myuint64_t attack_between[64][64]",
+        attack_gen_between[0],
+        64,
+        64
+    );
+    attack_gen_write_bitboards(
+        fp, "const myuint64_t attack_line[64][64]", attack_gen_line[0], 64, 64
+    );
+    attack_gen_write_distance(fp);
+
+    if (fclose(fp) != 0)
+    {
+        perror(argv[1]);
+        return CHESS_FILE_ERROR;
+    }
+
+    return CHESS_OK;
+}
+
+/* Set up M, for a slider on sq moving along dirs, its attack sets starting
+ * at offset.
+ *
+ * RETURN
+ * The offset past the attack sets of M.
+ */
+static myuint32_t attack_gen_slider(
+    attack_magic_p M, int sq, const int (*dirs)[2], myuint32_t offset,
+    int pext, myuint64_t* seed
+)
+{
+    static myuint64_t occupied[1 << ATTACK_GEN_MAX_BITS];
+    static myuint64_t attacks[1 << ATTACK_GEN_MAX_BITS];
+    myuint64_t        sub;
+    int               n;
+    int               i;
+
+    M->mask   = attack_gen_slide(sq, dirs, 0, 0);
+    M->magic  = 0;
+    M->offset = offset;
+    M->shift  = (myuint32_t)(64 - attack_gen_count(M->mask));
+
+    /* Every subset of the mask (carry-rippler enumeration) */
+    n         = 0;
+    sub       = 0;
+    do
+    {
+        occupied[n] = sub;
+        attacks[n]  = attack_gen_slide(sq, dirs, sub, 1);
+        ++n;
+        sub = (sub - M->mask) & M->mask;
+    } while (sub != 0);
+
+    if (pext)
+        for (i = 0; i < n; ++i)
+            attack_gen_table[offset + attack_gen_index(M, occupied[i], 1)] =
+                attacks[i];
+    else
+        while (!attack_gen_magic(M, occupied, attacks, n, seed))
+            ;
+
+    return offset + (myuint32_t)n;
+}
+
+/* Try a random magic number for M: it is kept if no two subsets of the mask
+ * with different attack sets share an index. The attack sets of M are then
+ * in place.
+ *
+ * RETURN
+ * 1 if the magic number was kept, 0 otherwise.
+ */
+static int attack_gen_magic(
+    attack_magic_p M, const myuint64_t* occupied, const myuint64_t* attacks,
+    int n, myuint64_t* seed
+)
+{
+    /* Attempt that last wrote each entry: the table is not cleared between
+     * attempts */
+    static unsigned long used[1 << ATTACK_GEN_MAX_BITS];
+    static unsigned long attempt;
+    myuint64_t*          table = attack_gen_table + M->offset;
+    size_t               idx;
+    int                  i;
+
+    /* Sparse numbers make good magics */
+    M->magic = attack_gen_random(seed) & attack_gen_random(seed) &
+               attack_gen_random(seed);
+
+    /* The top byte of the product must be dense enough to spread indexes */
+    if (attack_gen_count((M->mask * M->magic) >> 56) < 6)
+        return 0;
+
+    ++attempt;
+    for (i = 0; i < n; ++i)
+    {
+        idx = attack_gen_index(M, occupied[i], 0);
+
+        if (used[idx] != attempt)
+        {
+            used[idx]  = attempt;
+            table[idx] = attacks[i];
+        }
+        else if (table[idx] != attacks[i])
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* Squares reached from sq along dirs, up to the first occupied square of
+ * each direction; if edges is 0, the last square of each direction is left
+ * out (the mask of relevant squares, with occupied 0).
+ */
+static myuint64_t
+attack_gen_slide(int sq, const int (*dirs)[2], myuint64_t occupied, int edges)
+{
+    myuint64_t bb = 0;
+    int        d;
+    int        row;
+    int        col;
+
+    for (d = 0; d < 4; ++d)
+        for (row = sq / 8 + dirs[d][0], col = sq % 8 + dirs[d][1];
+             row >= 0 && row < 8 && col >= 0 && col < 8;
+             row += dirs[d][0], col += dirs[d][1])
+        {
+            if (!edges && (row + dirs[d][0] < 0 || row + dirs[d][0] > 7 ||
+                           col + dirs[d][1] < 0 || col + dirs[d][1] > 7))
+                break;
+
+            bb |= attack_gen_bit(8 * row + col);
+
+            if (occupied & attack_gen_bit(8 * row + col))
+                break;
+        }
+
+    return bb;
+}
+
+/* The index of attack.c, PEXT being done bit by bit */
+static size_t attack_gen_index(attack_magic_p M, myuint64_t occupied, int pext)
+{
+    myuint64_t mask;
+    size_t     idx;
+    size_t     bit;
+
+    if (!pext)
+        return (size_t)((occupied & M->mask) * M->magic >> M->shift);
+
+    idx = 0;
+    bit = 1;
+    for (mask = M->mask; mask != 0; mask &= mask - 1, bit <<= 1)
+        if (occupied & mask & (~mask + 1))
+            idx |= bit;
+
+    return idx;
+}
+
+/* Squares reached from sq by the first n steps */
+static myuint64_t attack_gen_leaper(int sq, const int (*steps)[2], int n)
+{
+    myuint64_t bb = 0;
+    int        row;
+    int        col;
+    int        i;
+
+    for (i = 0; i < n; ++i)
+    {
+        row = sq / 8 + steps[i][0];
+        col = sq % 8 + steps[i][1];
+
+        if (row >= 0 && row < 8 && col >= 0 && col < 8)
+            bb |= attack_gen_bit(8 * row + col);
+    }
+
+    return bb;
+}
+
+/* Set the between, line and distance entries of a and b */
+static void attack_gen_geometry(int a, int b)
+{
+    int dr   = b / 8 - a / 8;
+    int dc   = b % 8 - a % 8;
+    int adr  = dr < 0 ? -dr : dr;
+    int adc  = dc < 0 ? -dc : dc;
+    int step = 8 * attack_gen_sign(dr) + attack_gen_sign(dc);
+    int row;
+    int col;
+    int sq;
+
+    attack_gen_distance[a][b] = (myuint8_t)(adr > adc ? adr : adc);
+    attack_gen_between[a][b]  = 0;
+    attack_gen_line[a][b]     = 0;
+
+    /* Not on a row, a column or a diagonal */
+    if (a == b || (dr != 0 && dc != 0 && adr != adc))
+        return;
+
+    for (sq = a + step; sq != b; sq += step)
+        attack_gen_between[a][b] |= attack_gen_bit(sq);
+
+    /* Back to the edge, then across the board to the other edge */
+    for (row = a / 8, col = a % 8;
+         row - attack_gen_sign(dr) >= 0 && row - attack_gen_sign(dr) < 8 &&
+         col - attack_gen_sign(dc) >= 0 && col - attack_gen_sign(dc) < 8;
+         row -= attack_gen_sign(dr), col -= attack_gen_sign(dc))
+        ;
+
+    for (; row >= 0 && row < 8 && col >= 0 && col < 8;
+         row += attack_gen_sign(dr), col += attack_gen_sign(dc))
+        attack_gen_line[a][b] |= attack_gen_bit(8 * row + col);
+}
+
+static int attack_gen_sign(int x)
+{
+    return (x > 0) - (x < 0);
+}
+
+static myuint64_t attack_gen_bit(int sq)
+{
+    return (myuint64_t)1 << sq;
+}
+
+static int attack_gen_count(myuint64_t bb)
+{
+    int n;
+
+    for (n = 0; bb != 0; ++n)
+        bb &= bb - 1;
+
+    return n;
+}
+
+/* xorshift64 */
+static myuint64_t attack_gen_random(myuint64_t* seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 7;
+    *seed ^= *seed << 17;
+
+    return *seed;
+}
+
+static void
+attack_gen_write_magics(FILE* fp, const char* name, attack_magic_p M)
+{
+    int sq;
+
+    fprintf(fp, "const struct attack_magic_t %s[64] = {\n", name);
+
+    for (sq = 0; sq < 64; ++sq)
+        fprintf(
+            fp,
+            "    {MYUINT64_C(0x%08lx%08lx), MYUINT64_C(0x%08lx%08lx), %u, "
+            "%u},\n",
+            ATTACK_GEN_HALVES(M[sq].mask),
+            ATTACK_GEN_HALVES(M[sq].magic),
+            M[sq].offset,
+            M[sq].shift
+        );
+
+    fprintf(fp, "};\n\n");
+}
+
+/* Write the rows x cols array bb, declared by decl */
+static void attack_gen_write_bitboards(
+    FILE* fp, const char* decl, const myuint64_t* bb, int rows, int cols
+)
+{
+    int row;
+    int col;
+
+    fprintf(fp, "%s = {", decl);
+
+    for (row = 0; row < rows; ++row)
+    {
+        if (rows > 1)
+            fprintf(fp, "\n    {");
+
+        for (col = 0; col < cols; ++col)
+            fprintf(
+                fp,
+                "%sMYUINT64_C(0x%08lx%08lx),",
+                col % 3 == 0 ? (rows > 1 ? "\n        " : "\n    ") : " ",
+                ATTACK_GEN_HALVES(bb[row * cols + col])
+            );
+
+        if (rows > 1)
+            fprintf(fp, "\n    },");
+    }
+
+    fprintf(fp, "\n};\n\n");
+}
+
+static void attack_gen_write_distance(FILE* fp)
+{
+    int a;
+    int b;
+
+    fprintf(fp, "const myuint8_t attack_distance[64][64] = {");
+
+    for (a = 0; a < 64; ++a)
+    {
+        fprintf(fp, "\n    {");
+
+        for (b = 0; b < 64; ++b)
+            fprintf(
+                fp,
+                "%s%u,",
+                b % 16 == 0 ? "\n        " : " ",
+                attack_gen_distance[a][b]
+            );
+
+        fprintf(fp, "\n    },");
+    }
+
+    fprintf(fp, "\n};\n");
+}
@@ -0,0 +1,106 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+/* Write the KPK bitbase (see kpk.h) as a C source file.
+ *
+ * Usage: kpk-gen FILE
+ */
+
+#include <stdio.h>
+
+#include "exit_codes.h"
+#include "kpk.h"
+#include "tb.h"
+
+static int kpk_gen_win(int turn, int wking, int pawn, int bking);
+
+int main(int argc, char** argv)
+{
+    FILE*       fp;
+    const char* err;
+    unsigned    byte = 0;
+    size_t      idx  = 0;
+    int         turn;
+    int         wking;
+    int         pawn;
+    int         bking;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s FILE\n", argv[0]);
+        return CHESS_COMMAND_BAD_ARGS;
+    }
+
+    err = tb_generate("KPvK", 0);
+    if (err != NULL)
+    {
+        fprintf(stderr, "Error: KPvK: %s.\n", err);
+        return CHESS_GAME_ERROR;
+    }
+
+    fp = fopen(argv[1], "w");
+    if (fp == NULL)
+    {
+        perror(argv[1]);
+        return CHESS_FILE_ERROR;
+    }
+
+    fprintf(fp, "/* Generated by tools/kpk_gen.c: do not edit */\n\n");
+    fprintf(fp, "#include \"kpk.h\"\n\n");
+    fprintf(fp, "const myuint8_t kpk_table[KPK_POSITIONS / 8] = {");
+
+    /* In the order of the index of kpk.h */
+    for (turn = 0; turn < 2; ++turn)
+        for (wking = 0; wking < 32; ++wking)
+            for (pawn = 8; pawn < 56; ++pawn)
+                for (bking = 0; bking < 64; ++bking, ++idx)
+                {
+                    if (kpk_gen_win(
+                            turn, wking / 4 * 8 + wking % 4, pawn, bking
+                        ))
+                        byte |= 1U << idx % 8;
+
+                    if (idx % 8 != 7)
+                        continue;
+
+                    fprintf(
+                        fp, "%s0x%02x,", idx % 96 == 7 ? "\n    " : " ", byte
+                    );
+                    byte = 0;
+                }
+
+    fprintf(fp, "\n};\n");
+
+    if (fclose(fp) != 0)
+    {
+        perror(argv[1]);
+        return CHESS_FILE_ERROR;
+    }
+
+    return CHESS_OK;
+}
+
+static int kpk_gen_win(int turn, int wking, int pawn, int bking)
+{
+    struct board_t B;
+    int            dtm;
+
+    if (wking == pawn || wking == bking || pawn == bking)
+        return 0;
+
+    board_clear(&B);
+    board_put(&B, wking, cpWKING);
+    board_put(&B, pawn, cpWPAWN);
+    board_put(&B, bking, cpBKING);
+    B.wking.row = (myint8_t)(wking / 8);
+    B.wking.col = (myint8_t)(wking % 8);
+    B.bking.row = (myint8_t)(bking / 8);
+    B.bking.col = (myint8_t)(bking % 8);
+    board_index(&B);
+
+    if (tb_probe(&B, turn == 0 ? cpWTURN : cpBTURN, &dtm) != NULL)
+        return 0;
+
+    /* Only white can mate */
+    return dtm != TB_DRAW && dtm != TB_INVALID;
+}
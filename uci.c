@@ -0,0 +1,419 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "exit_codes.h"
+#include "search.h"
+#include "uci.h"
+#include "util.h"
+
+/* Moves left in the game when the GUI does not tell (movestogo) */
+#define UCI_MOVES_TO_GO 30
+
+typedef struct uci_t
+{
+    struct board_t board;
+    turn_t         turn;
+    int            depth; /* Depth option */
+
+    /* Search running on the worker thread, on its own copy of the board */
+    struct search_t search;
+    struct board_t  think_board;
+    turn_t          think_turn;
+    pthread_t       thread;
+    int             thinking; /* thread is to be joined */
+    double          budget;   /* Of go ponder, -1 for none */
+    int             infinite; /* Of the last go */
+
+    /* go infinite and go ponder answer only after stop (or ponderhit) */
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    int             hold;
+}* uci_p;
+
+static char* uci_word(char** cur);
+static void  uci_position(uci_p U, char* args);
+static void  uci_go(uci_p U, char* args);
+static void  uci_stop(uci_p U);
+static void  uci_ponderhit(uci_p U);
+static void* uci_think(void* arg);
+static void  uci_setoption(uci_p U, char* args);
+static void  uci_report(void* ctx, search_p S);
+
+int uci_run(void)
+{
+    struct uci_t U;
+    char         line[UCI_LINE_LENGTH];
+    char*        cur;
+    char*        cmd;
+
+    board_init(&U.board);
+    U.turn     = cpWTURN;
+    U.depth    = UCI_DEFAULT_DEPTH;
+    U.thinking = 0;
+    pthread_mutex_init(&U.lock, NULL);
+    pthread_cond_init(&U.cond, NULL);
+
+    while (fgets(line, sizeof(line), stdin) != NULL)
+    {
+        /* Not trim_right: it logs in debug builds, stdout is the protocol */
+        line[strcspn(line, "\r\n")] = '\0';
+
+        cur = line;
+        cmd = uci_word(&cur);
+
+        if (cmd == NULL)
+            continue;
+
+        if (strcmp(cmd, "uci") == 0)
+            printf(
+                "id name cmc-chess\n"
+                "id author Mattia Cabrini\n"
+                "option name Depth type spin default %d min 1 max %d\n"
+                "option name Ponder type check default false\n"
+                "uciok\n",
+                UCI_DEFAULT_DEPTH,
+                SEARCH_MAX_DEPTH
+            );
+        else if (strcmp(cmd, "isready") == 0)
+            printf("readyok\n");
+        else if (strcmp(cmd, "ucinewgame") == 0)
+        {
+            board_init(&U.board);
+            U.turn = cpWTURN;
+        }
+        else if (strcmp(cmd, "position") == 0)
+            uci_position(&U, cur);
+        else if (strcmp(cmd, "go") == 0)
+            uci_go(&U, cur);
+        else if (strcmp(cmd, "stop") == 0)
+            uci_stop(&U);
+        else if (strcmp(cmd, "ponderhit") == 0)
+            uci_ponderhit(&U);
+        else if (strcmp(cmd, "setoption") == 0)
+            uci_setoption(&U, cur);
+        else if (strcmp(cmd, "quit") == 0)
+            break;
+
+        fflush(stdout);
+    }
+
+    uci_stop(&U);
+    pthread_cond_destroy(&U.cond);
+    pthread_mutex_destroy(&U.lock);
+
+    return CHESS_OK;
+}
+
+/* Split the next blank separated word of *cur, NULL if there is none */
+static char* uci_word(char** cur)
+{
+    char* word = *cur;
+
+    while (*word == ' ' || *word == '\t' || *word == '\r' || *word == '\n')
+        ++word;
+
+    if (*word == '\0')
+        return NULL;
+
+    for (*cur = word; **cur != '\0'; ++*cur)
+        if (**cur == ' ' || **cur == '\t' || **cur == '\r' || **cur == '\n')
+        {
+            *(*cur)++ = '\0';
+            break;
+        }
+
+    return word;
+}
+
+static void uci_position(uci_p U, char* args)
+{
+    struct board_t B;
+    struct move_t  M;
+    struct coord_t whence;
+    move16_t       m;
+    turn_t         turn;
+    const char*    err;
+    const char*    end;
+    char*          word;
+    size_t         len;
+    piece_t        pawn_morph;
+
+    word = uci_word(&args);
+
+    if (word != NULL && strcmp(word, "startpos") == 0)
+    {
+        board_init(&B);
+        turn = cpWTURN;
+    }
+    else if (word != NULL && strcmp(word, "fen") == 0)
+    {
+        err = board_from_fen(&B, &turn, args, &end);
+        if (err != NULL)
+        {
+            printf("info string bad fen: %s\n", err);
+            return;
+        }
+
+        args += end - args;
+    }
+    else
+    {
+        printf("info string expected startpos or fen\n");
+        return;
+    }
+
+    /* Played on B: the position changes only if every move is legal */
+    word = uci_word(&args);
+    if (word != NULL && strcmp(word, "moves") == 0)
+        while ((word = uci_word(&args)) != NULL)
+        {
+            len = strlen(word);
+            m   = len <= 5 ? move16_from_str(word, len) : MOVE16_NONE;
+            if (m == MOVE16_NONE)
+            {
+                printf("info string bad move %s\n", word);
+                return;
+            }
+
+            move16_unpack(m, turn, &M, &pawn_morph);
+
+            err = board_check_move(&B, &M, pawn_morph, turn, &whence);
+            if (err != NULL)
+            {
+                printf("info string illegal move %s: %s\n", word, err);
+                return;
+            }
+
+            board_exec(&B, &M, pawn_morph);
+            turn = (turn_t)~turn;
+        }
+
+    U->board = B;
+    U->turn  = turn;
+}
+
+static void uci_go(uci_p U, char* args)
+{
+    search_p        S = &U->search;
+    char*           word;
+    char*           value;
+    long            depth     = 0;
+    long            movetime  = -1;
+    long            time[2]   = {-1, -1}; /* wtime, btime */
+    long            inc[2]    = {0, 0};   /* winc, binc */
+    long            movestogo = 0;
+    long            budget    = -1;
+    int             side      = U->turn == cpWTURN ? 0 : 1;
+    int             infinite  = 0;
+    int             ponder    = 0;
+
+    /* The GUI should have sent stop: the last search is thrown away */
+    uci_stop(U);
+
+    search_init(S);
+    S->report = uci_report;
+
+    while ((word = uci_word(&args)) != NULL)
+    {
+        /* searchmoves is ignored */
+        if (strcmp(word, "infinite") == 0)
+        {
+            infinite = 1;
+            continue;
+        }
+
+        if (strcmp(word, "ponder") == 0)
+        {
+            ponder = 1;
+            continue;
+        }
+
+        value = uci_word(&args);
+        if (value == NULL)
+            break;
+
+        if (strcmp(word, "depth") == 0)
+            depth = strtol(value, NULL, 10);
+        else if (strcmp(word, "movetime") == 0)
+            movetime = strtol(value, NULL, 10);
+        else if (strcmp(word, "wtime") == 0)
+            time[0] = strtol(value, NULL, 10);
+        else if (strcmp(word, "btime") == 0)
+            time[1] = strtol(value, NULL, 10);
+        else if (strcmp(word, "winc") == 0)
+            inc[0] = strtol(value, NULL, 10);
+        else if (strcmp(word, "binc") == 0)
+            inc[1] = strtol(value, NULL, 10);
+        else if (strcmp(word, "movestogo") == 0)
+            movestogo = strtol(value, NULL, 10);
+    }
+
+    if (movetime >= 0)
+        budget = movetime;
+    else if (time[side] >= 0)
+    {
+        budget = time[side] / (movestogo > 0 ? movestogo : UCI_MOVES_TO_GO) +
+                 inc[side] / 2;
+
+        /* Never risk the flag */
+        if (budget > time[side] / 2)
+            budget = time[side] / 2;
+    }
+
+    if (depth > 0)
+        S->max_depth = depth < SEARCH_MAX_DEPTH ? (int)depth : SEARCH_MAX_DEPTH;
+    else if (budget < 0 && !infinite && !ponder)
+        S->max_depth = U->depth;
+
+    /* The clock of go ponder starts at ponderhit */
+    U->budget = (double)budget;
+    if (ponder)
+        S->ponder = 1;
+    else if (budget >= 0)
+        S->deadline = clock_ms() + (double)budget;
+
+    U->think_board = U->board;
+    U->think_turn  = U->turn;
+    U->infinite    = infinite;
+    U->hold        = infinite || ponder;
+    U->thinking    = 1;
+
+    if (pthread_create(&U->thread, NULL, uci_think, U) != 0)
+    {
+        /* Answer anyway, without the worker: nothing could stop it */
+        U->thinking = 0;
+        U->hold     = 0;
+        S->ponder   = 0;
+        uci_think(U);
+    }
+}
+
+static void uci_stop(uci_p U)
+{
+    if (!U->thinking)
+        return;
+
+    /* Setting the flag under the lock: the worker cannot miss the wake up */
+    pthread_mutex_lock(&U->lock);
+    __atomic_store_n(&U->search.stop, 1, __ATOMIC_RELAXED);
+    pthread_cond_signal(&U->cond);
+    pthread_mutex_unlock(&U->lock);
+
+    pthread_join(U->thread, NULL);
+    U->thinking = 0;
+}
+
+static void uci_ponderhit(uci_p U)
+{
+    if (!U->thinking)
+        return;
+
+    pthread_mutex_lock(&U->lock);
+
+    if (__atomic_load_n(&U->search.ponder, __ATOMIC_RELAXED))
+    {
+        if (U->budget >= 0)
+            U->search.deadline = clock_ms() + U->budget;
+
+        /* Publishes deadline to the worker */
+        __atomic_store_n(&U->search.ponder, 0, __ATOMIC_RELEASE);
+
+        /* From now on a normal search, unless it is infinite */
+        U->hold = U->infinite;
+        pthread_cond_signal(&U->cond);
+    }
+
+    pthread_mutex_unlock(&U->lock);
+}
+
+static void* uci_think(void* arg)
+{
+    uci_p U = arg;
+    char  buf[MOVE16_STR_SIZE];
+    int   found;
+
+    found = search_run(&U->search, &U->think_board, U->think_turn);
+
+    pthread_mutex_lock(&U->lock);
+    while (U->hold && !__atomic_load_n(&U->search.stop, __ATOMIC_RELAXED))
+        pthread_cond_wait(&U->cond, &U->lock);
+    pthread_mutex_unlock(&U->lock);
+
+    if (found)
+        move16_to_str(
+            move16_pack(&U->search.best, U->search.best_morph), buf
+        );
+    else
+        strcpy(buf, "0000");
+
+    printf("bestmove %s\n", buf);
+    fflush(stdout);
+
+    return NULL;
+}
+
+static void uci_setoption(uci_p U, char* args)
+{
+    char* word;
+    char* name  = NULL;
+    char* value = NULL;
+
+    while ((word = uci_word(&args)) != NULL)
+    {
+        if (strcmp(word, "name") == 0)
+            name = uci_word(&args);
+        else if (strcmp(word, "value") == 0)
+            value = uci_word(&args);
+    }
+
+    /* The engine never thinks on the time of the other side unless told by
+     * go ponder: Ponder, whatever its value, changes nothing */
+    if (name != NULL && value != NULL && streq_ci(name, "Ponder") &&
+        (streq_ci(value, "true") || streq_ci(value, "false")))
+        return;
+
+    if (name == NULL || value == NULL || !streq_ci(name, "Depth"))
+    {
+        printf("info string unknown option\n");
+        return;
+    }
+
+    U->depth = atoi(value);
+    if (U->depth < 1)
+        U->depth = 1;
+    else if (U->depth > SEARCH_MAX_DEPTH)
+        U->depth = SEARCH_MAX_DEPTH;
+}
+
+static void uci_report(void* ctx, search_p S)
+{
+    char   buf[MOVE16_STR_SIZE];
+    double elapsed = clock_ms() - S->start;
+    int    mate    = search_mate_in(S->score);
+
+    (void)ctx;
+
+    move16_to_str(move16_pack(&S->best, S->best_morph), buf);
+
+    printf("info depth %d score ", S->depth);
+    if (mate != 0)
+        printf("mate %d", mate);
+    else
+        printf("cp %d", S->score);
+
+    printf(
+        " nodes %lu time %.0f nps %.0f pv %s\n",
+        S->nodes,
+        elapsed,
+        elapsed > 0 ? (double)S->nodes * 1000 / elapsed : 0,
+        buf
+    );
+    fflush(stdout);
+}
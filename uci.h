@@ -0,0 +1,40 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_UCI_H
+#define CMC_CHESS_UCI_H
+
+/* Universal Chess Interface front-end.
+ *
+ * Commands are read from stdin, one per line; replies go to stdout, flushed
+ * after every command. Nothing is rendered. Supported commands: uci,
+ * isready, ucinewgame, setoption, position (startpos or fen, then moves),
+ * go, stop, ponderhit, quit; anything else is ignored, as the protocol
+ * requires.
+ *
+ * position leaves the current position untouched if the FEN or any of the
+ * moves is rejected.
+ *
+ * go searches on a worker thread while commands keep being read: stop
+ * interrupts it within a node. go infinite and go ponder print bestmove
+ * only after stop (go ponder: or ponderhit, that starts its clock).
+ *
+ * Options: Depth, the depth of a go without limits; Ponder, accepted for
+ * the GUIs that send it (the engine ponders only on go ponder).
+ *
+ * Moves use the board semantics: castling and en passant moves are
+ * rejected.
+ */
+
+/* Longest line read, "position ... moves ..." included */
+#define UCI_LINE_LENGTH 8192
+
+/* Default of the Depth option: search depth of a go without limits */
+#define UCI_DEFAULT_DEPTH 5
+
+/* RETURN
+ * An exit code (see exit_codes.h).
+ */
+extern int uci_run(void);
+
+#endif /* CMC_CHESS_UCI_H */
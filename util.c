@@ -1,15 +1,17 @@
 /* Copyright (c) 2025 Mattia Cabrini      */
 /* SPDX-License-Identifier: AGPL-3.0-only */
 
+#define _POSIX_C_SOURCE 200809L
 #include <ctype.h>
+#include <stdio.h>
 #include <string.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
-#include "game_io.h"
 #include "util.h"
 
-void clear(void)
+void clear(FILE* fp)
 {
 #ifndef __AVR__
     size_t        i    = 0;
@@ -18,7 +20,9 @@ void clear(void)
     };
 
     for (i = 0; i < sizeof(CV); ++i)
-        game_io_putc(CV[i]);
+        fputc(CV[i], fp);
+#else
+    (void)fp;
 #endif
 }
 
@@ -26,7 +30,7 @@ int streq_ci(const char* str1, const char* str2)
 {
     while (*str1 && *str2)
     {
-        if (tolower(*str1) != tolower(*str2))
+        if (tolower((unsigned char)*str1) != tolower((unsigned char)*str2))
             return 0;
 
         ++str1;
@@ -40,7 +44,7 @@ int strneq_ci(const char* str1, const char* str2, size_t n)
 {
     while (*str1 && *str2 && n)
     {
-        if (tolower(*str1) != tolower(*str2))
+        if (tolower((unsigned char)*str1) != tolower((unsigned char)*str2))
             return 0;
 
         ++str1;
@@ -59,7 +63,7 @@ void trim_left(char* str)
     int     br = 0;
 
 #ifdef DEBUG
-    game_io_printf("DEBUG trim_left before: `%s`\n", str);
+    fprintf(stderr, "DEBUG trim_left before: `%s`\n", str);
 #endif
 
     len = (ssize_t)strlen(str);
@@ -73,7 +77,7 @@ void trim_left(char* str)
             str[cur] = str[cur + first_nb];
 
 #ifdef DEBUG
-    game_io_printf("DEBUG trim_left after: `%s`\n", str);
+    fprintf(stderr, "DEBUG trim_left after: `%s`\n", str);
 #endif
 }
 
@@ -82,7 +86,7 @@ void trim_right(char* str)
     size_t len;
 
 #ifdef DEBUG
-    game_io_printf("DEBUG trim_right before: `%s`\n", str);
+    fprintf(stderr, "DEBUG trim_right before: `%s`\n", str);
 #endif
 
     for (len = strlen(str); len > 0; --len)
@@ -93,7 +97,7 @@ void trim_right(char* str)
             len = 1;
 
 #ifdef DEBUG
-    game_io_printf("DEBUG trim_right after: `%s`\n", str);
+    fprintf(stderr, "DEBUG trim_right after: `%s`\n", str);
 #endif
 }
 
@@ -128,3 +132,23 @@ int file_copy(int fdsrc, int fddst)
 
     return 1;
 }
+
+unsigned int cpu_count(void)
+{
+    long n;
+
+    n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1)
+        return 1;
+
+    return (unsigned int)n;
+}
+
+double clock_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
@@ -6,6 +6,7 @@
 
 #include "exit_codes.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 
 #define assert_return_void(cond)                                               \
@@ -28,7 +29,7 @@
         }                                                                      \
     }
 
-extern void clear(void);
+extern void clear(FILE* fp);
 
 extern int         streq_ci(const char* str1, const char* str2);
 extern int         strneq_ci(const char* str1, const char* str2, size_t n);
@@ -40,4 +41,11 @@ extern void trim(char* str);
 
 extern int file_copy(int fdsrc, int fddst);
 
+/* Number of online processors, at least 1 */
+extern unsigned int cpu_count(void);
+
+/* Milliseconds elapsed since an unspecified point in time: only differences
+ * between two calls are meaningful */
+extern double clock_ms(void);
+
 #endif /* CMC_CHESS_UTIL_H */
@@ -0,0 +1,86 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#define _POSIX_C_SOURCE 200809L
+#include "workq.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+int workq_init(workq_p Q, size_t item_size, size_t capacity)
+{
+    Q->items = malloc(item_size * capacity);
+    if (Q->items == NULL)
+        return 0;
+
+    Q->item_size = item_size;
+    Q->capacity  = capacity;
+    Q->head      = 0;
+    Q->count     = 0;
+    Q->closed    = 0;
+
+    pthread_mutex_init(&Q->lock, NULL);
+    pthread_cond_init(&Q->not_empty, NULL);
+    pthread_cond_init(&Q->not_full, NULL);
+
+    return 1;
+}
+
+void workq_destroy(workq_p Q)
+{
+    pthread_cond_destroy(&Q->not_full);
+    pthread_cond_destroy(&Q->not_empty);
+    pthread_mutex_destroy(&Q->lock);
+
+    free(Q->items);
+    Q->items = NULL;
+}
+
+void workq_push(workq_p Q, const void* item)
+{
+    size_t tail;
+
+    pthread_mutex_lock(&Q->lock);
+
+    while (Q->count == Q->capacity)
+        pthread_cond_wait(&Q->not_full, &Q->lock);
+
+    tail = (Q->head + Q->count) % Q->capacity;
+    memcpy(Q->items + tail * Q->item_size, item, Q->item_size);
+    ++Q->count;
+
+    pthread_cond_signal(&Q->not_empty);
+    pthread_mutex_unlock(&Q->lock);
+}
+
+int workq_pop(workq_p Q, void* item)
+{
+    pthread_mutex_lock(&Q->lock);
+
+    while (Q->count == 0 && !Q->closed)
+        pthread_cond_wait(&Q->not_empty, &Q->lock);
+
+    if (Q->count == 0)
+    {
+        pthread_mutex_unlock(&Q->lock);
+        return 0;
+    }
+
+    memcpy(item, Q->items + Q->head * Q->item_size, Q->item_size);
+    Q->head = (Q->head + 1) % Q->capacity;
+    --Q->count;
+
+    pthread_cond_signal(&Q->not_full);
+    pthread_mutex_unlock(&Q->lock);
+
+    return 1;
+}
+
+void workq_close(workq_p Q)
+{
+    pthread_mutex_lock(&Q->lock);
+    Q->closed = 1;
+    pthread_cond_broadcast(&Q->not_empty);
+    pthread_mutex_unlock(&Q->lock);
+}
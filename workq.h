@@ -0,0 +1,50 @@
+/* Copyright (c) 2025 Mattia Cabrini      */
+/* SPDX-License-Identifier: AGPL-3.0-only */
+
+#ifndef CMC_CHESS_WORKQ_H
+#define CMC_CHESS_WORKQ_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+/* Bounded FIFO of fixed-size items shared by one producer and many worker
+ * threads.
+ *
+ * Items are copied in and out of the queue: the producer can reuse its buffer
+ * as soon as workq_push returns. Since the queue is bounded, a fast producer
+ * (e.g. a file reader) blocks instead of loading the whole input in memory.
+ */
+typedef struct workq_t
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  not_empty;
+    pthread_cond_t  not_full;
+
+    char*  items;
+    size_t item_size;
+    size_t capacity; /* In items */
+    size_t head;     /* Index of the oldest item */
+    size_t count;    /* Items in the queue */
+    int    closed;
+}* workq_p;
+
+/* RETURN
+ * 1 on success, 0 if memory could not be allocated.
+ */
+extern int  workq_init(workq_p Q, size_t item_size, size_t capacity);
+extern void workq_destroy(workq_p Q);
+
+/* Copy item into the queue, waiting for a free slot if needed */
+extern void workq_push(workq_p Q, const void* item);
+
+/* Copy the oldest item into item, waiting for one if needed.
+ *
+ * RETURN
+ * 1 if an item has been copied, 0 if the queue is closed and empty.
+ */
+extern int workq_pop(workq_p Q, void* item);
+
+/* No more items will be pushed: wake up every waiting worker */
+extern void workq_close(workq_p Q);
+
+#endif /* CMC_CHESS_WORKQ_H */